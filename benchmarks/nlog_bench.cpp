@@ -0,0 +1,315 @@
+/**
+ * @file nlog_bench.cpp
+ * @brief Throughput and latency benchmarks for neko::log
+ * @author moehoshio
+ * @copyright Copyright (c) 2025 Hoshi
+ * @license MIT OR Apache-2.0
+ */
+
+#include <neko/log/nlog.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifndef NEKO_LOG_VERSION
+#define NEKO_LOG_VERSION "unknown"
+#endif
+
+namespace {
+
+    using namespace neko;
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Discards records, measures the logger itself
+     */
+    class NullAppender : public log::IAppender {
+    public:
+        void append(const log::LogRecord &) override {}
+        bool isThreadSafe() const override {
+            return true;
+        }
+    };
+
+    struct Options {
+        unsigned maxThreads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+        std::size_t messages = 20000; // Per producer thread
+        std::string outputPath = "nlog_bench.json";
+        std::vector<std::string> appenders = {"null", "file", "buffered", "pattern", "console", "console-direct", "mmap", "binary"};
+        std::vector<std::string> modes = {"sync", "async"};
+        std::vector<std::string> messageKinds = {"literal", "formatted"};
+    };
+
+    struct Scenario {
+        std::string appender;
+        std::string mode;
+        std::string message;
+        unsigned threads;
+    };
+
+    struct Result {
+        Scenario scenario;
+        std::uint64_t messages = 0;
+        double seconds = 0;
+        double messagesPerSecond = 0;
+        std::uint64_t p50 = 0, p99 = 0, p999 = 0, max = 0; // Per-call latency in ns
+    };
+
+    std::vector<std::string> split(std::string_view list) {
+        std::vector<std::string> items;
+        std::size_t start = 0;
+        while (start <= list.size()) {
+            const auto end = std::min(list.find(',', start), list.size());
+            if (end > start) {
+                items.emplace_back(list.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        return items;
+    }
+
+    void printUsage(std::string_view program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "Measure neko::log throughput and per-call latency and write the results as JSON.\n\n"
+                  << "Options:\n"
+                  << "  --threads <n>      Largest producer thread count, runs 1, 2, 4, ... n (default: min(cores, 8))\n"
+                  << "  --messages <n>     Messages per producer thread (default: 20000)\n"
+                  << "  --appenders <list> Comma separated: null,file,buffered,pattern,console,console-direct,mmap,binary (default: all)\n"
+                  << "  --modes <list>     Comma separated: sync,async (default: both)\n"
+                  << "  --kinds <list>     Comma separated message kinds: literal,formatted (default: both)\n"
+                  << "  --output <file>    JSON output path (default: nlog_bench.json)\n"
+                  << "  -h, --help         Show this help\n\n"
+                  << "The console appenders write to standard output; redirect it, e.g. > /dev/null.\n";
+    }
+
+    std::unique_ptr<log::IAppender> makeAppender(const std::string &name, const std::filesystem::path &dir) {
+        if (name == "null") {
+            return std::make_unique<NullAppender>();
+        }
+        if (name == "file") {
+            return std::make_unique<log::FileAppender>((dir / "bench_file.log").string(), true);
+        }
+        if (name == "buffered") {
+            auto appender = std::make_unique<log::FileAppender>((dir / "bench_buffered.log").string(), true);
+            appender->setFlushPolicy(log::FlushPolicy::buffered());
+            return appender;
+        }
+        if (name == "pattern") {
+            // Same layout and flush policy as "buffered", formatted by PatternFormatter instead of DefaultFormatter
+            auto appender = std::make_unique<log::FileAppender>((dir / "bench_pattern.log").string(), true,
+                                                                std::make_unique<log::PatternFormatter>());
+            appender->setFlushPolicy(log::FlushPolicy::buffered());
+            return appender;
+        }
+        if (name == "console") {
+            return std::make_unique<log::ConsoleAppender>();
+        }
+        if (name == "console-direct") {
+            // Buffered console output written with write(2) instead of std::cout
+            auto appender = std::make_unique<log::ConsoleAppender>();
+            appender->setOutput(log::ConsoleOutput::Direct);
+            appender->setFlushPolicy(log::FlushPolicy::buffered());
+            return appender;
+        }
+#if NEKO_LOG_HAS_MMAP
+        if (name == "mmap") {
+            return std::make_unique<log::MmapFileAppender>((dir / "bench_mmap.log").string(), true);
+        }
+#endif
+        if (name == "binary") {
+            return std::make_unique<log::BinaryAppender>((dir / "bench_binary.nlog").string(), true);
+        }
+        return nullptr;
+    }
+
+    Result run(const Scenario &scenario, const Options &options, const std::filesystem::path &dir) {
+        log::Logger logger(log::Level::Info);
+        logger.clearAppenders();
+        logger.addAppender(makeAppender(scenario.appender, dir));
+
+        const bool async = scenario.mode == "async";
+        const bool formatted = scenario.message == "formatted";
+        std::thread consumer;
+        if (async) {
+            logger.setMode(neko::SyncMode::Async);
+            consumer = std::thread([&logger] { logger.runLoop(); });
+        }
+
+        std::vector<std::vector<std::uint32_t>> latencies(scenario.threads);
+        std::atomic<unsigned> ready{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> producers;
+        producers.reserve(scenario.threads);
+
+        for (unsigned t = 0; t < scenario.threads; ++t) {
+            producers.emplace_back([&, t] {
+                auto &samples = latencies[t];
+                samples.reserve(options.messages);
+                log::setCurrentThreadName("bench-" + std::to_string(t));
+
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+
+                for (std::size_t i = 0; i < options.messages; ++i) {
+                    const auto begin = Clock::now();
+                    if (formatted) {
+                        logger.info("benchmark message {} from thread {} value {:.3f}", neko::SrcLocInfo{}, i, t, 3.14159);
+                    } else {
+                        logger.info("benchmark literal message for throughput tests");
+                    }
+                    const auto end = Clock::now();
+                    samples.push_back(static_cast<std::uint32_t>(
+                        std::min<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(), UINT32_MAX)));
+                }
+            });
+        }
+
+        while (ready.load() != scenario.threads) {
+            std::this_thread::yield();
+        }
+        const auto start = Clock::now();
+        go.store(true, std::memory_order_release);
+
+        for (auto &producer : producers) {
+            producer.join();
+        }
+        // Throughput counts until every record reached the appender
+        if (async) {
+            logger.stopLoop();
+            consumer.join();
+        } else {
+            logger.flush();
+        }
+        const auto stop = Clock::now();
+
+        std::vector<std::uint32_t> all;
+        all.reserve(options.messages * scenario.threads);
+        for (const auto &samples : latencies) {
+            all.insert(all.end(), samples.begin(), samples.end());
+        }
+        std::sort(all.begin(), all.end());
+
+        Result result;
+        result.scenario = scenario;
+        result.messages = all.size();
+        result.seconds = std::chrono::duration<double>(stop - start).count();
+        result.messagesPerSecond = result.seconds > 0 ? static_cast<double>(result.messages) / result.seconds : 0;
+        if (!all.empty()) {
+            auto percentile = [&all](double p) {
+                return all[std::min(all.size() - 1, static_cast<std::size_t>(p * static_cast<double>(all.size())))];
+            };
+            result.p50 = percentile(0.50);
+            result.p99 = percentile(0.99);
+            result.p999 = percentile(0.999);
+            result.max = all.back();
+        }
+        return result;
+    }
+
+    std::string toJson(const std::vector<Result> &results, const Options &options) {
+        std::ostringstream out;
+        out << "{\n"
+            << "  \"library\": \"NekoLog\",\n"
+            << "  \"version\": \"" << NEKO_LOG_VERSION << "\",\n"
+            << "  \"timestamp\": " << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() << ",\n"
+            << "  \"hardwareConcurrency\": " << std::thread::hardware_concurrency() << ",\n"
+            << "  \"messagesPerThread\": " << options.messages << ",\n"
+            << "  \"results\": [";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto &r = results[i];
+            out << (i ? ",\n" : "\n")
+                << "    {\"appender\": \"" << r.scenario.appender << "\""
+                << ", \"mode\": \"" << r.scenario.mode << "\""
+                << ", \"message\": \"" << r.scenario.message << "\""
+                << ", \"threads\": " << r.scenario.threads
+                << ", \"messages\": " << r.messages
+                << ", \"seconds\": " << r.seconds
+                << ", \"messagesPerSecond\": " << static_cast<std::uint64_t>(r.messagesPerSecond)
+                << ", \"latencyNs\": {\"p50\": " << r.p50 << ", \"p99\": " << r.p99 << ", \"p99.9\": " << r.p999 << ", \"max\": " << r.max << "}}";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--threads" && hasValue) {
+            options.maxThreads = std::max(1u, static_cast<unsigned>(std::stoul(argv[++i])));
+        } else if (arg == "--messages" && hasValue) {
+            options.messages = std::stoull(argv[++i]);
+        } else if (arg == "--appenders" && hasValue) {
+            options.appenders = split(argv[++i]);
+        } else if (arg == "--modes" && hasValue) {
+            options.modes = split(argv[++i]);
+        } else if (arg == "--kinds" && hasValue) {
+            options.messageKinds = split(argv[++i]);
+        } else if (arg == "--output" && hasValue) {
+            options.outputPath = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<unsigned> threadCounts;
+    for (unsigned n = 1; n < options.maxThreads; n *= 2) {
+        threadCounts.push_back(n);
+    }
+    threadCounts.push_back(options.maxThreads);
+
+    const auto dir = std::filesystem::temp_directory_path() / "nlog_bench";
+    std::filesystem::create_directories(dir);
+
+    std::vector<Result> results;
+    for (const auto &appender : options.appenders) {
+        if (!makeAppender(appender, dir)) {
+            std::cerr << "Skipping unknown or unavailable appender: " << appender << "\n";
+            continue;
+        }
+        for (const auto &mode : options.modes) {
+            for (const auto &message : options.messageKinds) {
+                for (unsigned threads : threadCounts) {
+                    Scenario scenario{appender, mode, message, threads};
+                    results.push_back(run(scenario, options, dir));
+
+                    const auto &r = results.back();
+                    std::cerr << appender << " / " << mode << " / " << message << " / " << threads << " threads: "
+                              << static_cast<std::uint64_t>(r.messagesPerSecond) << " msg/s, p50 " << r.p50
+                              << " ns, p99 " << r.p99 << " ns, p99.9 " << r.p999 << " ns, max " << r.max << " ns\n";
+                }
+            }
+        }
+    }
+    std::filesystem::remove_all(dir);
+
+    std::ofstream out(options.outputPath, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open output file: " << options.outputPath << "\n";
+        return 1;
+    }
+    out << toJson(results, options);
+    std::cerr << "Results written to " << options.outputPath << "\n";
+    return 0;
+}
@@ -10,8 +10,23 @@ module;
 
 #include <format>
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
+#include <cmath>
+#include <concepts>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <variant>
 
 #include <atomic>
 #include <condition_variable>
@@ -26,10 +41,24 @@ module;
 
 #include <thread>
 
-#include <queue>
+#include <deque>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(_WIN32)
+#include <io.h>
+#endif
+
 // =====================
 // = Module Interface ==
 // =====================
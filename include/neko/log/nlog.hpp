@@ -34,12 +34,28 @@
 #include <neko/schema/srcLoc.hpp>
 #include <neko/schema/types.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
+#include <cmath>
+#include <concepts>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <variant>
 
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <new>
 
 #include <filesystem>
 #include <fstream>
@@ -50,12 +66,75 @@
 
 #include <thread>
 
-#include <queue>
+#include <deque>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(_WIN32)
+#include <io.h>
+#endif
+
 #endif // NEKO_LOG_ENABLE_MODULE
 
+/* ===================== */
+/* == Compile Options == */
+/* ===================== */
+
+/**
+ * @brief Compile-time minimum log level
+ * @note Numeric value of neko::log::Level (1 = Debug, 2 = Info, 3 = Warn, 4 = Error, 255 = Off).
+ *       Calls below this level are removed at compile time. Set through the CMake option of the same name.
+ */
+#ifndef NEKO_LOG_ACTIVE_LEVEL
+#define NEKO_LOG_ACTIVE_LEVEL 1
+#endif
+
+/**
+ * @brief Whether MmapFileAppender is available
+ * @note Detected from the POSIX memory mapping headers; define as 0 to disable it.
+ */
+#ifndef NEKO_LOG_HAS_MMAP
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#define NEKO_LOG_HAS_MMAP 1
+#else
+#define NEKO_LOG_HAS_MMAP 0
+#endif
+#endif
+
+/**
+ * @brief Whether raw file descriptor output (write, isatty) is available
+ * @note Enables terminal detection and ConsoleOutput::Direct; define as 0 to always go through iostreams.
+ */
+#ifndef NEKO_LOG_HAS_FD_IO
+#if __has_include(<unistd.h>) || defined(_WIN32)
+#define NEKO_LOG_HAS_FD_IO 1
+#else
+#define NEKO_LOG_HAS_FD_IO 0
+#endif
+#endif
+
+/**
+ * @brief Whether Logger::installCrashHandler is available
+ * @note Requires POSIX signals and raw file descriptor output; define as 0 to disable it.
+ */
+#ifndef NEKO_LOG_HAS_CRASH_HANDLER
+#if NEKO_LOG_HAS_FD_IO && __has_include(<signal.h>) && __has_include(<unistd.h>) && !defined(_WIN32)
+#define NEKO_LOG_HAS_CRASH_HANDLER 1
+#else
+#define NEKO_LOG_HAS_CRASH_HANDLER 0
+#endif
+#endif
+
 namespace neko::log {
 
     /**
@@ -69,6 +148,35 @@ namespace neko::log {
         Off = 255  ///< Logging off
     };
 
+    /**
+     * @brief What the async logger does when its queue is full
+     */
+    enum class OverflowPolicy : neko::uint8 {
+        Block,         ///< Wait for free space, never loses records (default)
+        DropNewest,    ///< Discard the record being logged
+        DropOldest,    ///< Discard the oldest queued record to make room
+        DropBelowLevel ///< Discard records below the overflow level, wait for space for the others
+    };
+
+    /**
+     * @brief Settings for the logger-owned async backend
+     */
+    struct AsyncOptions {
+        std::size_t queueCapacity = 8192;                      ///< Ring buffer slots (rounded up to a power of two)
+        OverflowPolicy overflowPolicy = OverflowPolicy::Block; ///< What to do when the ring buffer is full
+        Level overflowLevel = Level::Warn;                     ///< Kept level for OverflowPolicy::DropBelowLevel
+        std::size_t maxBatchSize = 256;                        ///< Records taken from the queue per batch
+        std::string threadName = "NekoLog";                   ///< Name of the backend thread in log records
+    };
+
+    /**
+     * @brief Time zone used when rendering timestamps
+     */
+    enum class TimeZone : neko::uint8 {
+        Local, ///< Local time (requires a time zone lookup once per second)
+        Utc    ///< UTC, computed without any time zone lookup
+    };
+
     /**
      * @brief Convert log level to string
      */
@@ -89,61 +197,519 @@ namespace neko::log {
         }
     }
 
+    /**
+     * @brief Compile-time minimum level, see NEKO_LOG_ACTIVE_LEVEL
+     */
+    inline constexpr Level activeLevel = static_cast<Level>(NEKO_LOG_ACTIVE_LEVEL);
+
+    /**
+     * @brief Check whether a level survives the compile-time filter
+     */
+    constexpr bool isActive(Level lv) noexcept {
+        return lv >= activeLevel && activeLevel != Level::Off;
+    }
+
+    namespace detail {
+
+        /// Assumed cache line size, used to keep hot atomics on separate lines
+        inline constexpr std::size_t cacheLineSize = 64;
+
+        /**
+         * @brief Transparent string hash, lets string-keyed containers be searched by string_view without a temporary
+         */
+        struct StringHash {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view str) const noexcept {
+                return std::hash<std::string_view>{}(str);
+            }
+        };
+
+        /**
+         * @brief Bounded lock-free queue with preallocated slots
+         * @note Based on Dmitry Vyukov's bounded MPMC queue. Every slot carries a sequence number,
+         *       so producers only contend on a single CAS of the enqueue position and never lock.
+         *       Used by the logger as a multi-producer / single-consumer ring buffer.
+         */
+        template <typename T>
+        class BoundedQueue {
+        private:
+            struct Slot {
+                std::atomic<std::size_t> sequence;
+                T value;
+            };
+
+            // Hands a claimed slot back to the other side when it goes out of scope
+            struct Publish {
+                std::atomic<std::size_t> &sequence;
+                std::size_t value;
+
+                ~Publish() {
+                    sequence.store(value, std::memory_order_release);
+                }
+            };
+
+            std::unique_ptr<Slot[]> slots;
+            std::size_t mask;
+
+            alignas(cacheLineSize) std::atomic<std::size_t> enqueuePos{0};
+            alignas(cacheLineSize) std::atomic<std::size_t> dequeuePos{0};
+
+            static std::size_t roundUpPow2(std::size_t n) noexcept {
+                std::size_t result = 2;
+                while (result < n) {
+                    result <<= 1;
+                }
+                return result;
+            }
+
+        public:
+            /**
+             * @brief Constructor
+             * @param capacity Number of slots, rounded up to a power of two (minimum 2)
+             */
+            explicit BoundedQueue(std::size_t capacity)
+                : slots(std::make_unique<Slot[]>(roundUpPow2(capacity))), mask(roundUpPow2(capacity) - 1) {
+                for (std::size_t i = 0; i <= mask; ++i) {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            BoundedQueue(const BoundedQueue &) = delete;
+            BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+            /**
+             * @brief Try to claim a free slot and fill it in place
+             * @param fill Called with the slot's value, which still holds whatever the previous occupant left behind
+             * @return false if the queue is full
+             * @note Assigning into the old value instead of moving a new one in keeps its heap buffers,
+             *       so the slots double as a free list of records. The slot is published even if fill throws.
+             */
+            template <typename F>
+            bool tryEmplace(F &&fill) {
+                std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+                for (;;) {
+                    Slot &slot = slots[pos & mask];
+                    std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+                    auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+                    if (diff == 0) {
+                        if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            Publish publish{slot.sequence, pos + 1};
+                            fill(slot.value);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        return false;
+                    } else {
+                        pos = enqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /**
+             * @brief Try to take the oldest slot and read it in place
+             * @param consume Called with the slot's value, which stays in the slot for reuse
+             * @return false if the queue is empty
+             */
+            template <typename F>
+            bool tryConsume(F &&consume) {
+                std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+                for (;;) {
+                    Slot &slot = slots[pos & mask];
+                    std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+                    auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+                    if (diff == 0) {
+                        if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            Publish publish{slot.sequence, pos + mask + 1};
+                            consume(slot.value);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        return false;
+                    } else {
+                        pos = dequeuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /**
+             * @brief Try to push a value, the value is only moved from on success
+             * @return false if the queue is full
+             */
+            bool tryPush(T &value) {
+                return tryEmplace([&value](T &slot) { slot = std::move(value); });
+            }
+
+            /**
+             * @brief Try to pop the oldest value into out
+             * @return false if the queue is empty
+             */
+            bool tryPop(T &out) {
+                return tryConsume([&out](T &slot) { out = std::move(slot); });
+            }
+
+            /**
+             * @brief Check whether the queue looks empty (approximate under concurrency)
+             */
+            bool empty() const noexcept {
+                return enqueuePos.load(std::memory_order_acquire) == dequeuePos.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @brief Approximate number of queued values
+             */
+            std::size_t size() const noexcept {
+                std::size_t head = dequeuePos.load(std::memory_order_acquire);
+                std::size_t tail = enqueuePos.load(std::memory_order_acquire);
+                return tail > head ? tail - head : 0;
+            }
+
+            std::size_t capacity() const noexcept {
+                return mask + 1;
+            }
+        };
+
+        /**
+         * @brief How long a background writer waits for more records before flushing what it wrote
+         */
+        inline constexpr std::chrono::milliseconds idleFlushDelay{50};
+
+        /**
+         * @brief Lets the single consumer of a queue sleep while it is empty
+         * @note Producers only take the lock when the consumer is actually parked.
+         */
+        class ConsumerParking {
+        private:
+            std::atomic<bool> parked = false;
+            std::mutex mutex;
+            std::condition_variable condVar;
+
+        public:
+            /**
+             * @brief Wake the consumer after publishing new work
+             */
+            void wake() {
+                // Pairs with the fence in wait: either the consumer sees the new work, or we see it parked
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (parked.load(std::memory_order_relaxed)) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    condVar.notify_one();
+                }
+            }
+
+            /**
+             * @brief Apply a state change under the lock and wake the consumer unconditionally
+             */
+            template <typename F>
+            void notify(F &&update) {
+                std::lock_guard<std::mutex> lock(mutex);
+                update();
+                condVar.notify_all();
+            }
+
+            /**
+             * @brief Sleep until ready() holds, a wake-up arrives or the timeout passes
+             * @return The last result of ready(), false if the wait timed out
+             * @note The default timeout is only a safety net, wake() does not rely on it.
+             */
+            template <typename Predicate>
+            bool wait(Predicate ready, std::chrono::milliseconds timeout = std::chrono::milliseconds(500)) {
+                std::unique_lock<std::mutex> lock(mutex);
+                parked.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const bool result = condVar.wait_for(lock, timeout, ready);
+                parked.store(false, std::memory_order_relaxed);
+                return result;
+            }
+        };
+
+        /**
+         * @brief Push into a full queue according to an overflow policy
+         * @param tryPush Attempts a single push, e.g. through BoundedQueue::tryEmplace
+         * @param onDrop Called once for every record dropped
+         * @return false if the item itself was dropped
+         */
+        template <typename T, typename TryPush, typename OnDrop>
+        bool pushWithPolicy(BoundedQueue<T> &queue, TryPush &&tryPush, Level itemLevel, OverflowPolicy policy, Level overflowLevel, OnDrop &&onDrop) {
+            // Fast path: one CAS on the ring buffer
+            if (tryPush()) {
+                return true;
+            }
+
+            switch (policy) {
+                case OverflowPolicy::DropNewest:
+                    onDrop();
+                    return false;
+                case OverflowPolicy::DropBelowLevel:
+                    if (itemLevel < overflowLevel) {
+                        onDrop();
+                        return false;
+                    }
+                    break;
+                case OverflowPolicy::DropOldest:
+                    while (!tryPush()) {
+                        // The evicted value stays in its slot, so the next push reuses its buffers
+                        if (queue.tryConsume([](T &) {})) {
+                            onDrop();
+                        }
+                    }
+                    return true;
+                case OverflowPolicy::Block:
+                    break;
+            }
+
+            while (!tryPush()) {
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Shared, immutable thread name carried by log records
+     * @note Copies share one reference-counted string, so records copy without allocating and the name
+     *       stays valid for as long as a record holds it, even after the thread exits or is renamed.
+     *       Assigning a std::string or a literal stores an owned copy.
+     */
+    class ThreadName {
+    private:
+        std::shared_ptr<const std::string> name;
+
+        static const std::string &emptyName() {
+            static const std::string empty;
+            return empty;
+        }
+
+    public:
+        ThreadName() = default;
+        ThreadName(std::string value)
+            : name(std::make_shared<const std::string>(std::move(value))) {}
+        ThreadName(std::string_view value)
+            : ThreadName(std::string(value)) {}
+        ThreadName(const char *value)
+            : ThreadName(std::string(value)) {}
+
+        ThreadName(const ThreadName &) = default;
+        ThreadName(ThreadName &&) noexcept = default;
+        ThreadName &operator=(ThreadName &&) noexcept = default;
+
+        // Records are reused for the same thread, so skip the reference count when nothing changes
+        ThreadName &operator=(const ThreadName &other) {
+            if (name != other.name) {
+                name = other.name;
+            }
+            return *this;
+        }
+
+        const std::string &str() const noexcept {
+            return name ? *name : emptyName();
+        }
+        std::string_view view() const noexcept {
+            return str();
+        }
+        const char *c_str() const noexcept {
+            return str().c_str();
+        }
+        std::size_t size() const noexcept {
+            return str().size();
+        }
+        bool empty() const noexcept {
+            return str().empty();
+        }
+
+        operator const std::string &() const noexcept {
+            return str();
+        }
+        operator std::string_view() const noexcept {
+            return str();
+        }
+
+        friend bool operator==(const ThreadName &lhs, const ThreadName &rhs) noexcept {
+            return lhs.name == rhs.name || lhs.view() == rhs.view();
+        }
+        friend bool operator==(const ThreadName &lhs, std::string_view rhs) noexcept {
+            return lhs.view() == rhs;
+        }
+        friend bool operator==(const ThreadName &lhs, const char *rhs) noexcept {
+            return lhs.view() == rhs;
+        }
+        friend bool operator==(const ThreadName &lhs, const std::string &rhs) noexcept {
+            return lhs.view() == rhs;
+        }
+        friend std::ostream &operator<<(std::ostream &os, const ThreadName &threadName) {
+            return os << threadName.str();
+        }
+    };
+
     /**
      * @brief Thread name manager
      */
     class ThreadNameManager {
     private:
-        std::unordered_map<std::thread::id, std::string> threadNames;
-        std::mutex namesMutex;
+        struct LocalCache;
+
+        struct State {
+            std::unordered_map<std::thread::id, std::string> threadNames;
+            // Caches of the threads that have logged, so that a rename only refreshes the thread it names
+            std::unordered_map<std::thread::id, LocalCache *> caches;
+            std::mutex namesMutex;
+        };
+
+        /**
+         * @brief Per-thread cache of the resolved name
+         * @note Owns the name handed to records. Its destructor runs at thread exit and removes the
+         *       thread's entries from the maps; records still holding the name keep it alive.
+         */
+        struct LocalCache {
+            const State *owner = nullptr;
+            std::weak_ptr<State> ownerRef;
+            std::atomic<bool> stale = true;
+            ThreadName name;
+
+            ~LocalCache() {
+                if (auto state = ownerRef.lock()) {
+                    std::lock_guard<std::mutex> lock(state->namesMutex);
+                    state->threadNames.erase(std::this_thread::get_id());
+                    state->caches.erase(std::this_thread::get_id());
+                }
+            }
+        };
+
+        std::shared_ptr<State> state = std::make_shared<State>();
+
+        static LocalCache &localCache() {
+            static thread_local LocalCache cache;
+            return cache;
+        }
+
+        static std::string defaultName(std::thread::id threadId) {
+            std::ostringstream oss;
+            oss << "Thread " << threadId;
+            return oss.str();
+        }
+
+        // Registers this thread's cache with the manager, moving it over from another manager if needed
+        void bindLocalCache() {
+            auto &cache = localCache();
+            if (cache.owner == state.get()) {
+                return;
+            }
+            if (auto previous = cache.ownerRef.lock()) {
+                std::lock_guard<std::mutex> lock(previous->namesMutex);
+                previous->caches.erase(std::this_thread::get_id());
+            }
+            std::lock_guard<std::mutex> lock(state->namesMutex);
+            cache.owner = state.get();
+            cache.ownerRef = state;
+            cache.stale.store(true, std::memory_order_relaxed);
+            state->caches[std::this_thread::get_id()] = &cache;
+        }
+
+        // Called with namesMutex held
+        void invalidate(std::thread::id threadId) {
+            if (auto it = state->caches.find(threadId); it != state->caches.end()) {
+                it->second->stale.store(true, std::memory_order_release);
+            }
+        }
+
+        LocalCache &currentCache() {
+            auto &cache = localCache();
+            if (cache.owner == state.get() && !cache.stale.load(std::memory_order_acquire)) {
+                return cache;
+            }
+
+            bindLocalCache();
+            std::string resolved;
+            {
+                std::lock_guard<std::mutex> lock(state->namesMutex);
+                // Cleared under the lock, so a rename that follows marks the cache stale again
+                cache.stale.store(false, std::memory_order_relaxed);
+                auto it = state->threadNames.find(std::this_thread::get_id());
+                resolved = it != state->threadNames.end() ? it->second : defaultName(std::this_thread::get_id());
+            }
+            if (resolved != cache.name.view()) {
+                cache.name = ThreadName(std::move(resolved));
+            }
+            return cache;
+        }
 
     public:
         /**
          * @brief Set the current thread's name
          */
         void setCurrentThreadName(const std::string &name) {
-            std::lock_guard<std::mutex> lock(namesMutex);
-            threadNames[std::this_thread::get_id()] = name;
+            bindLocalCache();
+            std::lock_guard<std::mutex> lock(state->namesMutex);
+            state->threadNames[std::this_thread::get_id()] = name;
+            invalidate(std::this_thread::get_id());
         }
 
         /**
          * @brief Set the name of the specified thread
          */
         void setThreadName(std::thread::id threadId, const std::string &name) {
-            std::lock_guard<std::mutex> lock(namesMutex);
-            threadNames[threadId] = name;
+            std::lock_guard<std::mutex> lock(state->namesMutex);
+            state->threadNames[threadId] = name;
+            invalidate(threadId);
         }
 
         /**
          * @brief Get thread name, returns thread ID string if not set
          */
         std::string getThreadName(std::thread::id threadId) {
-            std::lock_guard<std::mutex> lock(namesMutex);
-            auto it = threadNames.find(threadId);
-            if (it != threadNames.end()) {
+            std::lock_guard<std::mutex> lock(state->namesMutex);
+            auto it = state->threadNames.find(threadId);
+            if (it != state->threadNames.end()) {
                 return it->second;
             }
 
             // Returns thread ID as string
-            std::ostringstream oss;
-            oss << "Thread " << threadId;
-            return oss.str();
+            return defaultName(threadId);
+        }
+
+        /**
+         * @brief Get the current thread's name from the thread-local cache
+         * @note Only takes the lock when this thread was renamed since the last call.
+         */
+        const std::string &getCurrentThreadName() {
+            return currentCache().name.str();
+        }
+
+        /**
+         * @brief Get the current thread's name as a shared handle
+         * @note Copying the handle into a record does not allocate, and the record keeps the name alive.
+         */
+        const ThreadName &getCurrentThreadNameRef() {
+            return currentCache().name;
         }
 
         /**
          * @brief Remove thread name
          */
         void removeThreadName(std::thread::id threadId) {
-            std::lock_guard<std::mutex> lock(namesMutex);
-            threadNames.erase(threadId);
+            std::lock_guard<std::mutex> lock(state->namesMutex);
+            state->threadNames.erase(threadId);
+            invalidate(threadId);
         }
 
         /**
          * @brief Clear all thread names
          */
         void clearAllNames() {
-            std::lock_guard<std::mutex> lock(namesMutex);
-            threadNames.clear();
+            std::lock_guard<std::mutex> lock(state->namesMutex);
+            state->threadNames.clear();
+            for (auto &[threadId, cache] : state->caches) {
+                cache->stale.store(true, std::memory_order_release);
+            }
+        }
+
+        /**
+         * @brief Get the number of explicitly named threads
+         */
+        std::size_t getNameCount() {
+            std::lock_guard<std::mutex> lock(state->namesMutex);
+            return state->threadNames.size();
         }
     }
 #if !defined(NEKO_LOG_ENABLE_MODULE) || (NEKO_LOG_ENABLE_MODULE == false)
@@ -151,475 +717,4503 @@ namespace neko::log {
 #endif
         threadNameManager;
 
+    /**
+     * @brief Value of a structured field, kept typed until a formatter renders it
+     */
+    using FieldValue = std::variant<bool, neko::int64, neko::uint64, double, std::string>;
+
+    /**
+     * @brief Structured key/value field attached to a record, see kv()
+     */
+    struct Field {
+        std::string key;
+        FieldValue value;
+    };
+
+    /**
+     * @brief Types accepted as field values: arithmetic values and strings
+     */
+    template <typename T>
+    concept FieldValueType = std::is_arithmetic_v<std::remove_cvref_t<T>> || std::convertible_to<T, std::string_view>;
+
+    /**
+     * @brief Make a structured field, e.g. log::info("request done", {}, log::kv("status", 200), log::kv("ms", 12.5))
+     * @note Integers, floating point values, booleans and strings keep their type, so formatters such as
+     *       JsonFormatter render them without re-parsing any text. A char becomes a one-character string.
+     */
+    template <FieldValueType T>
+    Field kv(std::string_view key, T &&value) {
+        using V = std::remove_cvref_t<T>;
+        if constexpr (std::same_as<V, bool>) {
+            return {std::string(key), FieldValue(std::in_place_type<bool>, value)};
+        } else if constexpr (std::same_as<V, char>) {
+            return {std::string(key), FieldValue(std::in_place_type<std::string>, 1, value)};
+        } else if constexpr (std::is_floating_point_v<V>) {
+            return {std::string(key), FieldValue(std::in_place_type<double>, static_cast<double>(value))};
+        } else if constexpr (std::integral<V> && std::is_signed_v<V>) {
+            return {std::string(key), FieldValue(std::in_place_type<neko::int64>, static_cast<neko::int64>(value))};
+        } else if constexpr (std::integral<V>) {
+            return {std::string(key), FieldValue(std::in_place_type<neko::uint64>, static_cast<neko::uint64>(value))};
+        } else {
+            return {std::string(key), FieldValue(std::in_place_type<std::string>, std::string_view(value))};
+        }
+    }
+
+    namespace detail {
+
+        template <typename T>
+        inline constexpr bool isField = std::same_as<std::remove_cvref_t<T>, Field>;
+
+        /**
+         * @brief Trailing arguments that are all kv() fields
+         */
+        template <typename... Args>
+        concept FieldArgs = sizeof...(Args) > 0 && (isField<Args> && ...);
+
+        /**
+         * @brief Format arguments, which must not be kv() fields
+         */
+        template <typename... Args>
+        concept FormatArgs = !(isField<Args> || ...);
+
+    } // namespace detail
+
     /**
      * @brief Log record structure
+     * @note threadName shares the thread's cached name (see ThreadName), so records copy without allocating.
+     *       Records are reused by the log path; assigning a message into an existing record keeps its capacity.
      */
     struct LogRecord {
         Level level;
         std::string message;
         std::chrono::system_clock::time_point timestamp;
         neko::SrcLocInfo location;
-        std::string threadName;
+        ThreadName threadName;
+        std::vector<Field> fields; ///< Structured fields, see kv()
 
         LogRecord() = default;
         LogRecord(Level lvl, std::string msg, const neko::SrcLocInfo &loc = {})
-            : level(lvl), message(std::move(msg)),
-              timestamp(std::chrono::system_clock::now()), location(loc) {
-            threadName = threadNameManager.getThreadName(std::this_thread::get_id());
+            : message(std::move(msg)) {
+            stamp(lvl, loc);
         }
-    };
 
-    /**
-     * @brief Log formatter interface
-     */
-    class IFormatter {
-    public:
-        virtual ~IFormatter() = default;
-        virtual std::string format(const LogRecord &record) = 0;
+        /**
+         * @brief Set everything except the message for a record logged now by the calling thread
+         * @note Clears the fields, keeping their capacity.
+         */
+        void stamp(Level lvl, const neko::SrcLocInfo &loc) {
+            fields.clear();
+            level = lvl;
+            timestamp = std::chrono::system_clock::now();
+            location = loc;
+            threadName = threadNameManager.getCurrentThreadNameRef();
+        }
     };
 
-    /**
-     * @brief Default log formatter with configurable file path handling
-     */
-    class DefaultFormatter : public IFormatter {
-    private:
-        std::string rootPath;
-        bool useFullPath;
+    namespace detail {
 
-    public:
         /**
-         * @brief Constructor
-         * @param rootPath Root path for truncating file paths (empty = use filename only)
-         * @param useFullPath If true, use full file paths regardless of rootPath
+         * @brief Type tag written in front of every deferred argument
          */
-        explicit DefaultFormatter(const std::string &rootPath = "", bool useFullPath = false)
-            : rootPath(rootPath), useFullPath(useFullPath) {}
+        enum class ArgTag : neko::uint8 {
+            Bool = 1,
+            Char = 2,
+            Int = 3,    ///< Signed integer, widened to 8 bytes
+            UInt = 4,   ///< Unsigned integer, widened to 8 bytes
+            Float = 5,
+            Double = 6,
+            Pointer = 7,
+            String = 8 ///< 4 byte length followed by the characters
+        };
 
-        std::string format(const LogRecord &record) override {
-            // Format timestamp
-            auto time_t = std::chrono::system_clock::to_time_t(record.timestamp);
-            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          record.timestamp.time_since_epoch()) %
-                      1000;
+        template <typename T>
+        concept DeferrableString = std::same_as<T, const char *> || std::same_as<T, char *> ||
+                                   std::same_as<T, std::string> || std::same_as<T, std::string_view>;
 
-            std::tm tm;
-#ifdef _WIN32
-            localtime_s(&tm, &time_t);
-#else
-            localtime_r(&time_t, &tm);
-#endif
+        template <typename T>
+        concept DeferrableArg = std::same_as<T, bool> || std::same_as<T, char> ||
+                                (std::integral<T> && !std::same_as<T, bool> && sizeof(T) <= 8) ||
+                                std::same_as<T, float> || std::same_as<T, double> ||
+                                std::same_as<T, const void *> || std::same_as<T, void *> || std::same_as<T, std::nullptr_t> ||
+                                DeferrableString<T>;
+
+        /// All arguments can be copied into a DeferredFormat buffer
+        template <typename... Args>
+        concept DeferrableArgs = (DeferrableArg<std::decay_t<Args>> && ...);
 
-            auto truncatePath = [](const std::string &fullPath, const std::string &rootPath) -> std::string {
-                std::filesystem::path full(fullPath);
-                std::filesystem::path root(rootPath);
+        /**
+         * @brief Format string and arguments captured on the calling thread, formatted later by the backend
+         * @note Arguments are serialized into a fixed inline buffer so capturing never allocates.
+         *       The format string must have static storage duration, which holds for std::format_string literals.
+         */
+        class DeferredFormat {
+        public:
+            static constexpr std::size_t capacity = 128;
 
-                std::error_code ec;
-                auto rel = std::filesystem::relative(full, root, ec);
-                if (!ec && !rel.empty()) {
-                    return rel.string();
+            using FormatFn = void (*)(std::string_view fmt, const unsigned char *data, std::string &out);
+
+        private:
+            FormatFn formatFn = nullptr;
+            std::string_view fmt;
+            std::size_t size = 0;
+            std::array<unsigned char, capacity> data;
+
+            template <typename T>
+            using Decoded = std::conditional_t<DeferrableString<T>, std::string_view,
+                                               std::conditional_t<std::is_pointer_v<T> || std::is_null_pointer_v<T>, const void *, T>>;
+
+            bool write(const void *src, std::size_t n) {
+                if (n > capacity - size) {
+                    return false;
                 }
-                return fullPath;
-            };
+                std::memcpy(data.data() + size, src, n);
+                size += n;
+                return true;
+            }
 
-            // Handle file path based on configuration
-            std::string file;
-            if (useFullPath) {
-                file = record.location.getFile();
-            } else if (!rootPath.empty()) {
-                file = truncatePath(record.location.getFile(), rootPath);
-            } else {
-                file = std::filesystem::path(record.location.getFile()).filename().string();
+            template <typename T>
+            bool writeTagged(ArgTag tag, const T &value) {
+                return write(&tag, 1) && write(&value, sizeof(T));
             }
 
-            return std::format("[{:04}-{:02}-{:02} {:02}:{:02}:{:02}.{:03}] [{}] [{}] [{}:{}] {}",
-                               tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-                               tm.tm_hour, tm.tm_min, tm.tm_sec, ms.count(),
-                               levelToString(record.level),
-                               record.threadName,
-                               file, record.location.getLine(),
-                               record.message);
-        }
-    };
+            template <typename T>
+            bool encode(const T &value) {
+                if constexpr (std::same_as<T, bool>) {
+                    return writeTagged(ArgTag::Bool, value);
+                } else if constexpr (std::same_as<T, char>) {
+                    return writeTagged(ArgTag::Char, value);
+                } else if constexpr (std::integral<T> && std::is_signed_v<T>) {
+                    return writeTagged(ArgTag::Int, static_cast<neko::int64>(value));
+                } else if constexpr (std::integral<T>) {
+                    return writeTagged(ArgTag::UInt, static_cast<neko::uint64>(value));
+                } else if constexpr (std::same_as<T, float>) {
+                    return writeTagged(ArgTag::Float, value);
+                } else if constexpr (std::same_as<T, double>) {
+                    return writeTagged(ArgTag::Double, value);
+                } else if constexpr (DeferrableString<T>) {
+                    std::string_view str;
+                    if constexpr (std::is_pointer_v<T>) {
+                        if (value != nullptr) {
+                            str = value;
+                        }
+                    } else {
+                        str = value;
+                    }
+                    auto length = static_cast<neko::uint32>(str.size());
+                    return str.size() <= capacity && writeTagged(ArgTag::String, length) && write(str.data(), str.size());
+                } else {
+                    return writeTagged(ArgTag::Pointer, static_cast<const void *>(value));
+                }
+            }
 
-    /**
-     * @brief Log appender interface
-     */
-    class IAppender {
-    private:
-        Level level = Level::Debug; // Default to accept all levels
-        bool useLoggerLevel = true; // Default to use logger's level
+            template <typename T>
+            static T read(const unsigned char *&p) {
+                T value;
+                std::memcpy(&value, p, sizeof(T));
+                p += sizeof(T);
+                return value;
+            }
 
-    public:
-        virtual ~IAppender() = default;
-        virtual void append(const LogRecord &record) = 0;
-        virtual void flush() {}
+            template <typename T>
+            static Decoded<T> decode(const unsigned char *&p) {
+                ++p; // Skip the tag, the static type is known here
+                if constexpr (std::integral<T> && !std::same_as<T, bool> && !std::same_as<T, char>) {
+                    using Wide = std::conditional_t<std::is_signed_v<T>, neko::int64, neko::uint64>;
+                    return static_cast<T>(read<Wide>(p));
+                } else if constexpr (DeferrableString<T>) {
+                    auto length = read<neko::uint32>(p);
+                    std::string_view str(reinterpret_cast<const char *>(p), length);
+                    p += length;
+                    return str;
+                } else {
+                    return read<Decoded<T>>(p);
+                }
+            }
+
+            template <typename... Args>
+            static void formatDeferred(std::string_view fmt, const unsigned char *data, std::string &out) {
+                const unsigned char *p = data;
+                // Braced initialization guarantees left-to-right decoding
+                std::tuple<Decoded<Args>...> values{decode<Args>(p)...};
+                out.clear();
+                std::apply([&](auto &...args) { std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(args...)); }, values);
+            }
+
+        public:
+            /**
+             * @brief Capture a format string and its arguments
+             * @return false if the arguments do not fit into the inline buffer
+             */
+            template <typename... Args>
+                requires DeferrableArgs<Args...>
+            bool capture(std::string_view format, const Args &...args) {
+                size = 0;
+                if (!(encode<std::decay_t<const Args>>(args) && ...)) {
+                    size = 0;
+                    return false;
+                }
+                fmt = format;
+                formatFn = &formatDeferred<std::decay_t<const Args>...>;
+                return true;
+            }
+
+            bool empty() const noexcept {
+                return formatFn == nullptr;
+            }
+
+            void reset() noexcept {
+                formatFn = nullptr;
+                size = 0;
+            }
+
+            /**
+             * @brief Run std::format on the captured arguments
+             */
+            void formatTo(std::string &out) const {
+                if (formatFn) {
+                    formatFn(fmt, data.data(), out);
+                }
+            }
+
+            std::string_view getFormat() const noexcept {
+                return fmt;
+            }
+
+            /**
+             * @brief Tagged argument bytes, see ArgTag
+             */
+            std::span<const unsigned char> getArgs() const noexcept {
+                return {data.data(), size};
+            }
+        };
 
         /**
-         * @brief Set appender's log level
+         * @brief Element of the async ring buffer
          */
-        void setLevel(Level lvl) {
-            level = lvl;
-            useLoggerLevel = false;
-        }
+        struct AsyncRecord {
+            LogRecord record;
+            DeferredFormat deferred;
+
+            /**
+             * @brief Produce the final message if formatting was deferred
+             */
+            void materialize() {
+                if (!deferred.empty()) {
+                    deferred.formatTo(record.message);
+                    deferred.reset();
+                }
+            }
+        };
 
         /**
-         * @brief Get appender's log level
+         * @brief Message capacity reserved for every batch entry of an async consumer
          */
-        Level getLevel() const {
-            return level;
-        }
+        inline constexpr std::size_t batchMessageReserve = 256;
 
         /**
-         * @brief Set to use logger's level instead of appender's level
+         * @brief Create every entry a consumer's batch can use, with message buffers reserved up front
+         * @note Entries are otherwise created and grown the first time a batch reaches them, which can happen
+         *       long after startup when a burst makes batches larger than before.
          */
-        void setLoggerLevel(bool use = true) {
-            useLoggerLevel = use;
+        inline void prepareBatch(std::vector<LogRecord> &batch, std::size_t size) {
+            batch.resize(size);
+            for (auto &entry : batch) {
+                entry.message.reserve(batchMessageReserve);
+            }
         }
 
         /**
-         * @brief Check if this appender should use logger's level
+         * @brief The calling thread's reusable record for the synchronous log path
+         * @note Keeps its message capacity between calls. A nested log call made while it is in use,
+         *       for example from a formatter, gets a fresh record instead.
          */
-        bool shouldUseLoggerLevel() const {
-            return useLoggerLevel;
-        }
+        class ScratchRecord {
+        private:
+            struct Local {
+                LogRecord record;
+                bool inUse = false;
+            };
+
+            static Local &local() {
+                static thread_local Local cache;
+                return cache;
+            }
+
+            Local &cache = local();
+            std::optional<LogRecord> fallback;
+            LogRecord *record;
+
+        public:
+            ScratchRecord() {
+                if (cache.inUse) {
+                    record = &fallback.emplace();
+                } else {
+                    cache.inUse = true;
+                    record = &cache.record;
+                }
+            }
+
+            ScratchRecord(const ScratchRecord &) = delete;
+            ScratchRecord &operator=(const ScratchRecord &) = delete;
+
+            ~ScratchRecord() {
+                if (!fallback) {
+                    cache.inUse = false;
+                }
+            }
+
+            LogRecord &operator*() noexcept {
+                return *record;
+            }
+
+            LogRecord *operator->() noexcept {
+                return record;
+            }
+        };
 
         /**
-         * @brief Check if the given level should be logged by this appender
+         * @brief Identifies one limiter: the logger, the call site, the rule and its parameters
          */
-        bool isEnabled(Level logLevel, Level loggerLevel) const {
-            Level effectiveLevel = useLoggerLevel ? loggerLevel : level;
-            return logLevel >= effectiveLevel && effectiveLevel != Level::Off;
+        struct CallsiteKey {
+            const void *owner = nullptr;
+            neko::cstr file = nullptr;
+            neko::uint32 line = 0;
+            neko::uint8 rule = 0;
+            std::uint64_t count = 0;
+            std::int64_t interval = 0; // Nanoseconds
+
+            bool operator==(const CallsiteKey &) const noexcept = default;
+
+            std::size_t hash() const noexcept {
+                std::size_t seed = std::hash<const void *>{}(owner);
+                for (std::size_t value : {std::hash<const void *>{}(file), static_cast<std::size_t>(line), static_cast<std::size_t>(rule),
+                                          static_cast<std::size_t>(count), static_cast<std::size_t>(interval)}) {
+                    seed ^= value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2);
+                }
+                return seed;
+            }
+        };
+
+        /**
+         * @brief Rate limiting state of one call site
+         */
+        struct CallsiteLimit {
+            std::atomic<neko::uint8> status = 0; // 0 empty, 1 being claimed, 2 ready
+            CallsiteKey key;
+            std::atomic<std::uint64_t> count = 0;
+            std::atomic<std::int64_t> nextAllowed = 0; // Steady clock nanoseconds
+            std::atomic<std::uint64_t> suppressed = 0;
+
+            bool everyN(std::uint64_t n) noexcept {
+                return count.fetch_add(1, std::memory_order_relaxed) % std::max<std::uint64_t>(n, 1) == 0;
+            }
+
+            bool firstN(std::uint64_t n) noexcept {
+                return count.load(std::memory_order_relaxed) < n && count.fetch_add(1, std::memory_order_relaxed) < n;
+            }
+
+            /**
+             * @brief Token bucket refilled with one token per interval and holding at most burst tokens
+             * @note Implemented as the generic cell rate algorithm, so the whole bucket is a single atomic.
+             */
+            bool takeToken(std::chrono::nanoseconds interval, std::uint64_t burst) noexcept {
+                const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count();
+                const std::int64_t step = std::max<std::int64_t>(interval.count(), 1);
+                const std::int64_t tolerance = step * static_cast<std::int64_t>(std::max<std::uint64_t>(burst, 1) - 1);
+                std::int64_t next = nextAllowed.load(std::memory_order_relaxed);
+                for (;;) {
+                    if (now < next - tolerance) {
+                        return false;
+                    }
+                    if (nextAllowed.compare_exchange_weak(next, std::max(next, now) + step, std::memory_order_relaxed)) {
+                        return true;
+                    }
+                }
+            }
+
+            /**
+             * @brief Count a rejected line
+             */
+            void settle(bool allowed) noexcept {
+                if (!allowed) {
+                    suppressed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * @brief Take the number of rejections to report with a line that is being written
+             */
+            std::uint64_t take() noexcept {
+                return suppressed.load(std::memory_order_relaxed) == 0 ? 0 : suppressed.exchange(0, std::memory_order_relaxed);
+            }
+        };
+
+        /**
+         * @brief Lock-free open-addressing table of limiter states; a full table chains to the next one
+         */
+        struct CallsiteTable {
+            static constexpr std::size_t size = 1024;
+            std::array<CallsiteLimit, size> entries;
+            std::atomic<CallsiteTable *> next = nullptr;
+        };
+
+        /**
+         * @brief Find or create the limiter state for a key
+         * @note Entries are never removed, so each call site should use constant parameters. Returns nullptr only when
+         *       another table cannot be allocated; Logger::Limited then rejects the call.
+         */
+        inline CallsiteLimit *callsiteLimit(const CallsiteKey &key) noexcept {
+            static CallsiteTable root;
+
+            const std::size_t hash = key.hash();
+            for (CallsiteTable *table = &root; table != nullptr;) {
+                for (std::size_t probe = 0; probe < CallsiteTable::size; ++probe) {
+                    CallsiteLimit &entry = table->entries[(hash + probe) & (CallsiteTable::size - 1)];
+                    neko::uint8 status = entry.status.load(std::memory_order_acquire);
+                    if (status == 0) {
+                        if (entry.status.compare_exchange_strong(status, 1, std::memory_order_acquire)) {
+                            entry.key = key;
+                            entry.status.store(2, std::memory_order_release);
+                            return &entry;
+                        }
+                    }
+                    while (status == 1) {
+                        std::this_thread::yield();
+                        status = entry.status.load(std::memory_order_acquire);
+                    }
+                    if (entry.key == key) {
+                        return &entry;
+                    }
+                }
+
+                // Full: continue in the next table, creating it if no other thread has yet
+                CallsiteTable *next = table->next.load(std::memory_order_acquire);
+                if (next == nullptr) {
+                    auto *created = new (std::nothrow) CallsiteTable();
+                    if (created == nullptr) {
+                        return nullptr;
+                    }
+                    if (table->next.compare_exchange_strong(next, created, std::memory_order_acq_rel)) {
+                        next = created;
+                    } else {
+                        delete created;
+                    }
+                }
+                table = next;
+            }
+            return nullptr;
         }
-    };
+
+    } // namespace detail
 
     /**
-     * @brief Console appender
+     * @brief Callable producing a log message, evaluated only when the level is enabled
      */
-    class ConsoleAppender : public IAppender {
-    private:
-        std::unique_ptr<IFormatter> formatter;
-        mutable std::mutex mutex;
+    template <typename F>
+    concept MessageProducer = std::invocable<F &> && std::convertible_to<std::invoke_result_t<F &>, std::string>;
 
+    /**
+     * @brief Log formatter interface
+     */
+    class IFormatter {
     public:
-        explicit ConsoleAppender(std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
-            : formatter(std::move(formatter)) {
-            preOutput();
+        virtual ~IFormatter() = default;
+        virtual std::string format(const LogRecord &record) = 0;
+
+        /**
+         * @brief Append the formatted record to out
+         * @note Appenders call this with a buffer they keep between records. The default adapts format(),
+         *       override it to write into out directly and skip the temporary string.
+         */
+        virtual void formatTo(const LogRecord &record, std::string &out) {
+            out += format(record);
         }
+    };
 
-        explicit ConsoleAppender(Level level, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
-            : formatter(std::move(formatter)) {
-            setLevel(level);
-            preOutput();
+    namespace detail {
+
+        /**
+         * @brief Write value as zero-padded decimal digits
+         */
+        inline void writeDigits(char *out, unsigned value, int width) noexcept {
+            for (int i = width - 1; i >= 0; --i) {
+                out[i] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
         }
 
-        void preOutput() {
-            std::lock_guard<std::mutex> lock(mutex);
-            std::cout << "=== ConsoleAppender initialized ===" << std::endl;
-            std::cout << "=== Level: " << levelToString(getLevel()) << " ===" << std::endl;
-            std::cout << "=== Log Start ===" << std::endl;
+        /**
+         * @brief Thread-safe conversion to local calendar time
+         */
+        inline std::tm localTime(std::time_t time) noexcept {
+            std::tm tm{};
+#ifdef _WIN32
+            localtime_s(&tm, &time);
+#else
+            localtime_r(&time, &tm);
+#endif
+            return tm;
         }
 
-        void append(const LogRecord &record) override {
-            constexpr neko::strview
-                red = "\033[31m",
-                green = "\033[32m",
-                yellow = "\033[33m",
-                blue = "\033[34m",
-                magenta = "\033[35m",
-                cyan = "\033[36m",
-                reset = "\033[0m";
+        /**
+         * @brief Render "YYYY-MM-DD HH:MM:SS" for a time point
+         * @note The result is cached per thread and per time zone, so records within the same second
+         *       reuse it. The returned view stays valid until the next call on the same thread.
+         */
+        inline std::string_view formatDateTime(std::chrono::system_clock::time_point tp, TimeZone tz) {
+            struct Entry {
+                neko::int64 second = std::numeric_limits<neko::int64>::min();
+                char text[19];
+            };
+            static thread_local Entry cache[2];
 
-            std::lock_guard<std::mutex> lock(mutex);
-            auto formatted = formatter->format(record);
+            auto seconds = std::chrono::floor<std::chrono::seconds>(tp);
+            Entry &entry = cache[tz == TimeZone::Utc ? 1 : 0];
+            if (entry.second == seconds.time_since_epoch().count()) {
+                return {entry.text, sizeof(entry.text)};
+            }
+
+            int year;
+            unsigned month, day, hour, minute, second;
+            if (tz == TimeZone::Utc) {
+                auto days = std::chrono::floor<std::chrono::days>(seconds);
+                std::chrono::year_month_day ymd(days);
+                std::chrono::hh_mm_ss hms(seconds - days);
+                year = static_cast<int>(ymd.year());
+                month = static_cast<unsigned>(ymd.month());
+                day = static_cast<unsigned>(ymd.day());
+                hour = static_cast<unsigned>(hms.hours().count());
+                minute = static_cast<unsigned>(hms.minutes().count());
+                second = static_cast<unsigned>(hms.seconds().count());
+            } else {
+                std::tm tm = localTime(std::chrono::system_clock::to_time_t(seconds));
+                year = tm.tm_year + 1900;
+                month = static_cast<unsigned>(tm.tm_mon + 1);
+                day = static_cast<unsigned>(tm.tm_mday);
+                hour = static_cast<unsigned>(tm.tm_hour);
+                minute = static_cast<unsigned>(tm.tm_min);
+                second = static_cast<unsigned>(tm.tm_sec);
+            }
 
-            switch (record.level) {
-                case Level::Debug:
-                    std::cout << blue << formatted << reset << std::endl;
+            char *text = entry.text;
+            writeDigits(text, static_cast<unsigned>(year), 4);
+            text[4] = '-';
+            writeDigits(text + 5, month, 2);
+            text[7] = '-';
+            writeDigits(text + 8, day, 2);
+            text[10] = ' ';
+            writeDigits(text + 11, hour, 2);
+            text[13] = ':';
+            writeDigits(text + 14, minute, 2);
+            text[16] = ':';
+            writeDigits(text + 17, second, 2);
+            entry.second = seconds.time_since_epoch().count();
+            return {entry.text, sizeof(entry.text)};
+        }
+
+        /**
+         * @brief Append "YYYY-MM-DD HH:MM:SS.mmm" for a time point
+         */
+        inline void appendTimestamp(std::string &out, std::chrono::system_clock::time_point tp, TimeZone tz) {
+            out.append(formatDateTime(tp, tz));
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()) % 1000;
+            char millis[4] = {'.'};
+            writeDigits(millis + 1, static_cast<unsigned>(ms.count() < 0 ? ms.count() + 1000 : ms.count()), 3);
+            out.append(millis, sizeof(millis));
+        }
+
+        template <typename T>
+        void appendNumber(std::string &out, T value) {
+            char digits[32];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            out.append(digits, result.ptr);
+        }
+
+        /**
+         * @brief Append " key=value" for every field, strings unquoted
+         */
+        inline void appendFieldsText(std::string &out, std::span<const Field> fields) {
+            for (const auto &field : fields) {
+                out += ' ';
+                out += field.key;
+                out += '=';
+                std::visit([&out](const auto &value) {
+                    using V = std::decay_t<decltype(value)>;
+                    if constexpr (std::same_as<V, bool>) {
+                        out += value ? "true" : "false";
+                    } else if constexpr (std::same_as<V, std::string>) {
+                        out += value;
+                    } else {
+                        appendNumber(out, value);
+                    }
+                },
+                           field.value);
+            }
+        }
+
+        inline void appendJsonEscapedByte(std::string &out, unsigned char c) {
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
                     break;
-                case Level::Info:
-                    std::cout << reset << formatted << reset << std::endl;
+                case '\r':
+                    out += "\\r";
                     break;
-                case Level::Warn:
-                    std::cout << yellow << formatted << reset << std::endl;
+                case '\t':
+                    out += "\\t";
                     break;
-                case Level::Error:
-                    std::cerr << red << formatted << reset << std::endl;
+                case '\b':
+                    out += "\\b";
                     break;
-                case Level::Off:
+                case '\f':
+                    out += "\\f";
                     break;
-                default:
-                    std::cout << formatted << std::endl;
+                default: {
+                    constexpr std::string_view hex = "0123456789abcdef";
+                    const char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                    out.append(escaped, sizeof(escaped));
                     break;
+                }
             }
         }
 
-        void flush() override {
-            std::lock_guard<std::mutex> lock(mutex);
-            std::cout.flush();
-            std::cerr.flush();
+        /**
+         * @brief Append str with JSON string escaping (without the quotes)
+         * @note Scans eight bytes per step with word-at-a-time arithmetic and copies clean runs in bulk.
+         *       Only a word containing a quote, a backslash or a control character is looked at byte by byte.
+         */
+        inline void appendJsonEscaped(std::string &out, std::string_view str) {
+            constexpr std::uint64_t ones = 0x0101010101010101ULL;
+            constexpr std::uint64_t highBits = 0x8080808080808080ULL;
+            const char *data = str.data();
+            const std::size_t size = str.size();
+            std::size_t runStart = 0;
+            std::size_t i = 0;
+
+            auto escapeAt = [&](std::size_t pos) {
+                const auto c = static_cast<unsigned char>(data[pos]);
+                if (c < 0x20 || c == '"' || c == '\\') {
+                    out.append(data + runStart, pos - runStart);
+                    appendJsonEscapedByte(out, c);
+                    runStart = pos + 1;
+                }
+            };
+
+            for (; i + 8 <= size; i += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, data + i, 8);
+                const std::uint64_t quote = word ^ (ones * '"');
+                const std::uint64_t backslash = word ^ (ones * '\\');
+                // Non-zero when some byte is below 0x20, or equals '"' or '\\' (a zero byte after the XOR)
+                const std::uint64_t special = ((word - ones * 0x20) & ~word) |
+                                              ((quote - ones) & ~quote) |
+                                              ((backslash - ones) & ~backslash);
+                if ((special & highBits) == 0) {
+                    continue;
+                }
+                for (std::size_t pos = i; pos < i + 8; ++pos) {
+                    escapeAt(pos);
+                }
+            }
+            for (; i < size; ++i) {
+                escapeAt(i);
+            }
+            out.append(data + runStart, size - runStart);
+        }
+
+        /**
+         * @brief Append a field value as a JSON value, non-finite numbers become null
+         */
+        inline void appendJsonValue(std::string &out, const FieldValue &value) {
+            std::visit([&out](const auto &v) {
+                using V = std::decay_t<decltype(v)>;
+                if constexpr (std::same_as<V, bool>) {
+                    out += v ? "true" : "false";
+                } else if constexpr (std::same_as<V, std::string>) {
+                    out += '"';
+                    appendJsonEscaped(out, v);
+                    out += '"';
+                } else if constexpr (std::same_as<V, double>) {
+                    if (std::isfinite(v)) {
+                        appendNumber(out, v);
+                    } else {
+                        out += "null";
+                    }
+                } else {
+                    appendNumber(out, v);
+                }
+            },
+                       value);
+        }
+
+        /**
+         * @brief Display path for a source file, keyed by the address of the file name
+         * @note SrcLocInfo file names are string literals with static storage, so the pointer identifies the file
+         *       and the (possibly filesystem-based) truncation runs once per file instead of once per record.
+         *       Hits are read lock-free from a small pointer-keyed table; only a miss takes the mutex.
+         */
+        class PathCache {
+        private:
+            struct Entry {
+                neko::cstr file;
+                std::string path;
+            };
+
+            static constexpr std::size_t slotCount = 64; // Power of two
+            static constexpr std::size_t maxProbes = 8;
+
+            std::array<std::atomic<const Entry *>, slotCount> slots{};
+            // Owns every entry ever handed out and only grows, so returned views live as long as the cache
+            std::deque<Entry> entries;
+            // Files that found no free slot within maxProbes
+            std::unordered_map<neko::cstr, const Entry *> overflow;
+            std::mutex mutex;
+
+            static std::size_t slotOf(neko::cstr file) noexcept {
+                auto h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(file));
+                h ^= h >> 29;
+                h *= 0x9E3779B97F4A7C15ull;
+                return static_cast<std::size_t>(h >> 32) & (slotCount - 1);
+            }
+
+            template <typename Fn>
+            std::string_view insert(neko::cstr file, Fn &&compute) {
+                std::lock_guard<std::mutex> lock(mutex);
+                const std::size_t start = slotOf(file);
+                for (std::size_t i = 0; i < maxProbes; ++i) {
+                    auto &slot = slots[(start + i) & (slotCount - 1)];
+                    const Entry *entry = slot.load(std::memory_order_relaxed);
+                    if (entry == nullptr) {
+                        entry = &entries.emplace_back(Entry{file, compute(file)});
+                        slot.store(entry, std::memory_order_release);
+                        return entry->path;
+                    }
+                    if (entry->file == file) {
+                        return entry->path;
+                    }
+                }
+                auto it = overflow.find(file);
+                if (it == overflow.end()) {
+                    it = overflow.emplace(file, &entries.emplace_back(Entry{file, compute(file)})).first;
+                }
+                return it->second->path;
+            }
+
+        public:
+            PathCache() = default;
+            PathCache(const PathCache &) {}
+
+            /**
+             * @brief Forget the cached paths, which depend on the settings of the formatter being assigned
+             * @note Entries stay allocated, so views returned earlier remain valid.
+             */
+            PathCache &operator=(const PathCache &) {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto &slot : slots) {
+                    slot.store(nullptr, std::memory_order_relaxed);
+                }
+                overflow.clear();
+                return *this;
+            }
+
+            template <typename Fn>
+            std::string_view get(neko::cstr file, Fn &&compute) {
+                const std::size_t start = slotOf(file);
+                for (std::size_t i = 0; i < maxProbes; ++i) {
+                    const Entry *entry = slots[(start + i) & (slotCount - 1)].load(std::memory_order_acquire);
+                    if (entry == nullptr) {
+                        break;
+                    }
+                    if (entry->file == file) {
+                        return entry->path;
+                    }
+                }
+                return insert(file, std::forward<Fn>(compute));
+            }
+        };
+
+        inline bool isPathSeparator(char c) noexcept {
+            return c == '/' || c == '\\';
+        }
+
+        /**
+         * @brief Get the file name component of a path without touching the filesystem
+         */
+        inline std::string_view fileName(std::string_view path) noexcept {
+            auto pos = path.find_last_of("/\\");
+            return pos == std::string_view::npos ? path : path.substr(pos + 1);
+        }
+
+        /**
+         * @brief Make path relative to rootPath
+         * @note Tries a plain string prefix strip first (treating '/' and '\\' alike) and only
+         *       falls back to std::filesystem::relative when the prefix does not match.
+         */
+        inline std::string relativePath(std::string_view path, std::string_view rootPath) {
+            if (rootPath.size() <= path.size()) {
+                bool match = true;
+                for (std::size_t i = 0; i < rootPath.size() && match; ++i) {
+                    match = path[i] == rootPath[i] || (isPathSeparator(path[i]) && isPathSeparator(rootPath[i]));
+                }
+                std::size_t start = rootPath.size();
+                // The prefix must end on a component boundary
+                if (match && (start == path.size() || isPathSeparator(path[start]) || isPathSeparator(rootPath.back()))) {
+                    while (start < path.size() && isPathSeparator(path[start])) {
+                        ++start;
+                    }
+                    if (start < path.size()) {
+                        return std::string(path.substr(start));
+                    }
+                }
+            }
+
+            std::error_code ec;
+            auto rel = std::filesystem::relative(std::filesystem::path(path), std::filesystem::path(rootPath), ec);
+            if (!ec && !rel.empty()) {
+                return rel.string();
+            }
+            return std::string(path);
         }
-    };
+
+    } // namespace detail
 
     /**
-     * @brief File appender
+     * @brief Default log formatter with configurable file path handling
      */
-    class FileAppender : public IAppender {
+    class DefaultFormatter : public IFormatter {
     private:
-        std::unique_ptr<IFormatter> formatter;
-        std::ofstream file;
-        mutable std::mutex mutex;
+        std::string rootPath;
+        bool useFullPath;
+        TimeZone timeZone;
+        detail::PathCache pathCache;
 
     public:
-        explicit FileAppender(const std::string &filename, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
-            : formatter(std::move(formatter)), file(filename, isTruncate ? std::ios::trunc : std::ios::app) {
-            if (!file.is_open()) {
-                throw neko::ex::FileError("Failed to open log file: " + filename);
+        /**
+         * @brief Constructor
+         * @param rootPath Root path for truncating file paths (empty = use filename only)
+         * @param useFullPath If true, use full file paths regardless of rootPath
+         * @param timeZone Render timestamps in local time or UTC
+         */
+        explicit DefaultFormatter(const std::string &rootPath = "", bool useFullPath = false, TimeZone timeZone = TimeZone::Local)
+            : rootPath(rootPath), useFullPath(useFullPath), timeZone(timeZone) {}
+
+        /**
+         * @brief Get the file path as displayed in the log for a source file name
+         */
+        std::string_view displayPath(neko::cstr file) {
+            if (useFullPath) {
+                return file;
+            }
+            return pathCache.get(file, [this](neko::cstr path) {
+                return rootPath.empty() ? std::string(detail::fileName(path)) : detail::relativePath(path, rootPath);
+            });
+        }
+
+        std::string format(const LogRecord &record) override {
+            std::string result;
+            formatTo(record, result);
+            return result;
+        }
+
+        void formatTo(const LogRecord &record, std::string &out) override {
+            formatFieldsTo(out, record.level, record.timestamp, record.threadName,
+                           record.location.getFile(), record.location.getLine(), record.message);
+            detail::appendFieldsText(out, record.fields);
+        }
+
+        /**
+         * @brief Format a record given as separate fields
+         * @note Used where no LogRecord exists, such as when decoding binary logs. Display paths are cached by pointer, so file must stay valid and unchanged.
+         */
+        std::string formatFields(Level level, std::chrono::system_clock::time_point timestamp, std::string_view threadName,
+                                 neko::cstr file, neko::uint32 line, std::string_view message) {
+            std::string result;
+            formatFieldsTo(result, level, timestamp, threadName, file, line, message);
+            return result;
+        }
+
+        /**
+         * @brief Append a record given as separate fields to out
+         */
+        void formatFieldsTo(std::string &out, Level level, std::chrono::system_clock::time_point timestamp, std::string_view threadName,
+                            neko::cstr file, neko::uint32 line, std::string_view message) {
+            std::string_view path = displayPath(file);
+
+            // The date and time prefix is cached per second, only the milliseconds change between records
+            out.reserve(out.size() + 64 + threadName.size() + path.size() + message.size());
+            out += '[';
+            detail::appendTimestamp(out, timestamp, timeZone);
+            std::format_to(std::back_inserter(out), "] [{}] [{}] [{}:{}] {}",
+                           levelToString(level),
+                           threadName,
+                           path, line,
+                           message);
+        }
+    };
+
+    /**
+     * @brief Formatter driven by a pattern string
+     * @note The pattern is compiled once in the constructor into a flat list of field operations and literal spans,
+     *       so formatting a record is a single loop without any parsing. Date and time fields are cut from the
+     *       per-second cached "YYYY-MM-DD HH:MM:SS" text, and adjacent ones are merged into a single copy.
+     *
+     *       %Y year, %m month, %d day, %H hour, %M minute, %S second, %e milliseconds, %f microseconds,
+     *       %l level, %t thread name, %s source file (display path), %g source file (full path), %# line,
+     *       %! function, %v message, %k structured fields as " key=value" pairs, %% a literal '%'.
+     */
+    class PatternFormatter : public IFormatter {
+    public:
+        /// Same layout as DefaultFormatter
+        static constexpr std::string_view defaultPattern = "[%Y-%m-%d %H:%M:%S.%e] [%l] [%t] [%s:%#] %v%k";
+
+    private:
+        enum class Field : neko::uint8 {
+            Literal,  ///< Span of literals
+            DateTime, ///< Span of the cached date and time text
+            Millis,
+            Micros,
+            Level,
+            Thread,
+            Source,
+            FullPath,
+            Line,
+            Function,
+            Message,
+            Fields
+        };
+
+        struct Op {
+            Field field;
+            neko::uint32 offset = 0;
+            neko::uint32 size = 0;
+        };
+
+        // Layout of detail::formatDateTime, used to merge date fields and the separators between them
+        static constexpr std::string_view dateTimeLayout = "YYYY-MM-DD HH:MM:SS";
+
+        std::string pattern;
+        std::string literals;
+        std::vector<Op> ops;
+        bool usesDateTime = false;
+        TimeZone timeZone;
+        std::string rootPath;
+        detail::PathCache pathCache;
+
+        void addDateTime(neko::uint32 offset, neko::uint32 size) {
+            usesDateTime = true;
+            if (!ops.empty() && ops.back().field == Field::DateTime && ops.back().offset + ops.back().size == offset) {
+                ops.back().size += size;
+                return;
+            }
+            ops.push_back({Field::DateTime, offset, size});
+        }
+
+        void addLiteral(char c) {
+            if (!ops.empty() && ops.back().field == Field::DateTime) {
+                const std::size_t end = ops.back().offset + ops.back().size;
+                if (end < dateTimeLayout.size() && dateTimeLayout[end] == c) {
+                    ++ops.back().size;
+                    return;
+                }
+            }
+            if (!ops.empty() && ops.back().field == Field::Literal && ops.back().offset + ops.back().size == literals.size()) {
+                ++ops.back().size;
+            } else {
+                ops.push_back({Field::Literal, static_cast<neko::uint32>(literals.size()), 1});
+            }
+            literals += c;
+        }
+
+        void compile() {
+            for (std::size_t i = 0; i < pattern.size(); ++i) {
+                if (pattern[i] != '%') {
+                    addLiteral(pattern[i]);
+                    continue;
+                }
+                if (++i == pattern.size()) {
+                    throw neko::ex::InvalidArgument("Log pattern ends with '%': " + pattern);
+                }
+                switch (pattern[i]) {
+                    case 'Y':
+                        addDateTime(0, 4);
+                        break;
+                    case 'm':
+                        addDateTime(5, 2);
+                        break;
+                    case 'd':
+                        addDateTime(8, 2);
+                        break;
+                    case 'H':
+                        addDateTime(11, 2);
+                        break;
+                    case 'M':
+                        addDateTime(14, 2);
+                        break;
+                    case 'S':
+                        addDateTime(17, 2);
+                        break;
+                    case 'e':
+                        ops.push_back({Field::Millis});
+                        break;
+                    case 'f':
+                        ops.push_back({Field::Micros});
+                        break;
+                    case 'l':
+                        ops.push_back({Field::Level});
+                        break;
+                    case 't':
+                        ops.push_back({Field::Thread});
+                        break;
+                    case 's':
+                        ops.push_back({Field::Source});
+                        break;
+                    case 'g':
+                        ops.push_back({Field::FullPath});
+                        break;
+                    case '#':
+                        ops.push_back({Field::Line});
+                        break;
+                    case '!':
+                        ops.push_back({Field::Function});
+                        break;
+                    case 'v':
+                        ops.push_back({Field::Message});
+                        break;
+                    case 'k':
+                        ops.push_back({Field::Fields});
+                        break;
+                    case '%':
+                        addLiteral('%');
+                        break;
+                    default:
+                        throw neko::ex::InvalidArgument("Unknown log pattern flag '%" + std::string(1, pattern[i]) + "' in: " + pattern);
+                }
+            }
+        }
+
+        template <typename Duration, int Digits>
+        static void appendFraction(std::string &out, std::chrono::system_clock::time_point tp) {
+            auto fraction = std::chrono::duration_cast<Duration>(tp - std::chrono::floor<std::chrono::seconds>(tp));
+            char digits[Digits];
+            detail::writeDigits(digits, static_cast<unsigned>(fraction.count()), Digits);
+            out.append(digits, Digits);
+        }
+
+    public:
+        /**
+         * @brief Constructor
+         * @param pattern Layout of a line, see the class description for the flags
+         * @param timeZone Render timestamps in local time or UTC
+         * @param rootPath Root path for truncating file paths in %s (empty = use filename only)
+         * @throws neko::ex::InvalidArgument if the pattern contains an unknown flag
+         */
+        explicit PatternFormatter(std::string_view pattern = defaultPattern, TimeZone timeZone = TimeZone::Local, const std::string &rootPath = "")
+            : pattern(pattern), timeZone(timeZone), rootPath(rootPath) {
+            compile();
+        }
+
+        const std::string &getPattern() const noexcept {
+            return pattern;
+        }
+
+        std::string format(const LogRecord &record) override {
+            std::string result;
+            formatTo(record, result);
+            return result;
+        }
+
+        void formatTo(const LogRecord &record, std::string &out) override {
+            std::string_view dateTime;
+            if (usesDateTime) {
+                dateTime = detail::formatDateTime(record.timestamp, timeZone);
+            }
+
+            for (const Op &op : ops) {
+                switch (op.field) {
+                    case Field::Literal:
+                        out.append(literals, op.offset, op.size);
+                        break;
+                    case Field::DateTime:
+                        out.append(dateTime.substr(op.offset, op.size));
+                        break;
+                    case Field::Millis:
+                        appendFraction<std::chrono::milliseconds, 3>(out, record.timestamp);
+                        break;
+                    case Field::Micros:
+                        appendFraction<std::chrono::microseconds, 6>(out, record.timestamp);
+                        break;
+                    case Field::Level:
+                        out += levelToString(record.level);
+                        break;
+                    case Field::Thread:
+                        out += record.threadName;
+                        break;
+                    case Field::Source:
+                        out += pathCache.get(record.location.getFile(), [this](neko::cstr path) {
+                            return rootPath.empty() ? std::string(detail::fileName(path)) : detail::relativePath(path, rootPath);
+                        });
+                        break;
+                    case Field::FullPath:
+                        out += record.location.getFile();
+                        break;
+                    case Field::Line: {
+                        char digits[10];
+                        auto result = std::to_chars(digits, digits + sizeof(digits), record.location.getLine());
+                        out.append(digits, result.ptr);
+                        break;
+                    }
+                    case Field::Function:
+                        out += record.location.getFuncName();
+                        break;
+                    case Field::Message:
+                        out += record.message;
+                        break;
+                    case Field::Fields:
+                        detail::appendFieldsText(out, record.fields);
+                        break;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Formatter writing one JSON object per record
+     * @note Keys: time (ISO 8601, with a 'Z' suffix in UTC), level, thread, file, line, message,
+     *       followed by the record's structured fields with their typed values.
+     */
+    class JsonFormatter : public IFormatter {
+    private:
+        TimeZone timeZone;
+        std::string rootPath;
+        bool useFullPath;
+        detail::PathCache pathCache;
+
+        std::string_view displayPath(neko::cstr file) {
+            if (useFullPath) {
+                return file;
+            }
+            return pathCache.get(file, [this](neko::cstr path) {
+                return rootPath.empty() ? std::string(detail::fileName(path)) : detail::relativePath(path, rootPath);
+            });
+        }
+
+    public:
+        /**
+         * @brief Constructor
+         * @param timeZone Render timestamps in UTC (default) or local time
+         * @param rootPath Root path for truncating file paths (empty = use filename only)
+         * @param useFullPath If true, use full file paths regardless of rootPath
+         */
+        explicit JsonFormatter(TimeZone timeZone = TimeZone::Utc, const std::string &rootPath = "", bool useFullPath = false)
+            : timeZone(timeZone), rootPath(rootPath), useFullPath(useFullPath) {}
+
+        std::string format(const LogRecord &record) override {
+            std::string result;
+            formatTo(record, result);
+            return result;
+        }
+
+        void formatTo(const LogRecord &record, std::string &out) override {
+            out += "{\"time\":\"";
+            const std::size_t time = out.size();
+            detail::appendTimestamp(out, record.timestamp, timeZone);
+            out[time + 10] = 'T';
+            if (timeZone == TimeZone::Utc) {
+                out += 'Z';
+            }
+            out += "\",\"level\":\"";
+            out += levelToString(record.level);
+            out += "\",\"thread\":\"";
+            detail::appendJsonEscaped(out, record.threadName);
+            out += "\",\"file\":\"";
+            detail::appendJsonEscaped(out, displayPath(record.location.getFile()));
+            out += "\",\"line\":";
+            detail::appendNumber(out, record.location.getLine());
+            out += ",\"message\":\"";
+            detail::appendJsonEscaped(out, record.message);
+            out += '"';
+            for (const auto &field : record.fields) {
+                out += ",\"";
+                if (isReservedKey(field.key)) {
+                    out += "fields.";
+                }
+                detail::appendJsonEscaped(out, field.key);
+                out += "\":";
+                detail::appendJsonValue(out, field.value);
+            }
+            out += '}';
+        }
+
+        /**
+         * @brief Whether a field key collides with one of the record's own keys
+         * @note Such fields are written as "fields.<key>" so that every object has unique keys.
+         */
+        static bool isReservedKey(std::string_view key) noexcept {
+            return key == "time" || key == "level" || key == "thread" || key == "file" || key == "line" || key == "message";
+        }
+    };
+
+    /**
+     * @brief Log appender interface
+     */
+    class IAppender {
+    private:
+        Level level = Level::Debug; // Default to accept all levels
+        bool useLoggerLevel = true; // Default to use logger's level
+
+    public:
+        virtual ~IAppender() = default;
+        virtual void append(const LogRecord &record) = 0;
+        virtual void flush() {}
+
+        /**
+         * @brief Called by a background writer once no records have arrived for a while
+         * @note Writes what the appender buffered, so a FlushPolicy interval also holds when logging stops.
+         *       The default calls flush().
+         */
+        virtual void flushIdle() {
+            flush();
+        }
+
+        /**
+         * @brief Append several records at once
+         * @note The async backend calls this with runs of enabled records. The default appends them one by one;
+         *       override it to take a lock and write once per batch.
+         */
+        virtual void appendBatch(std::span<const LogRecord> records) {
+            for (const auto &record : records) {
+                append(record);
+            }
+        }
+
+        /**
+         * @brief Set appender's log level
+         */
+        void setLevel(Level lvl) {
+            level = lvl;
+            useLoggerLevel = false;
+        }
+
+        /**
+         * @brief Get appender's log level
+         */
+        Level getLevel() const {
+            return level;
+        }
+
+        /**
+         * @brief Set to use logger's level instead of appender's level
+         */
+        void setLoggerLevel(bool use = true) {
+            useLoggerLevel = use;
+        }
+
+        /**
+         * @brief Check if this appender should use logger's level
+         */
+        bool shouldUseLoggerLevel() const {
+            return useLoggerLevel;
+        }
+
+        /**
+         * @brief Check if the given level should be logged by this appender
+         */
+        bool isEnabled(Level logLevel, Level loggerLevel) const {
+            Level effectiveLevel = useLoggerLevel ? loggerLevel : level;
+            return logLevel >= effectiveLevel && effectiveLevel != Level::Off;
+        }
+
+        /**
+         * @brief Whether append, appendBatch and flush may be called from several threads at once
+         * @note The logger serializes the calls to appenders that return false (the default). The built-in appenders
+         *       lock internally and return true, so logging threads only contend inside them.
+         */
+        virtual bool isThreadSafe() const {
+            return false;
+        }
+    };
+
+    /**
+     * @brief Decides when a buffered appender hands its buffer to the OS
+     * @note A record triggers a flush when any enabled condition holds. The interval is checked when a record is appended;
+     *       behind the async backend or an AsyncAppender, the buffer is also flushed once no records have arrived for a short while.
+     *       In sync mode an idle appender keeps its buffer until the next record or an explicit flush().
+     */
+    struct FlushPolicy {
+        std::size_t bufferSize = 0;             ///< Flush once this many bytes are buffered (0 = flush after every record)
+        std::chrono::milliseconds interval{0};  ///< Flush once the buffer is older than this (0 = disabled)
+        Level flushLevel = Level::Off;          ///< Flush immediately on records at or above this level (Off = disabled)
+
+        /**
+         * @brief Flush after every record (the default)
+         */
+        static constexpr FlushPolicy immediate() noexcept {
+            return {};
+        }
+
+        /**
+         * @brief Buffer records, flushing on size, age or severity
+         */
+        static constexpr FlushPolicy buffered(std::size_t bufferSize = 64 * 1024,
+                                              std::chrono::milliseconds interval = std::chrono::milliseconds(100),
+                                              Level flushLevel = Level::Error) noexcept {
+            return {bufferSize, interval, flushLevel};
+        }
+
+        /**
+         * @brief Whether a buffer should be written after a record of the given level was added
+         */
+        bool due(std::size_t buffered, Level recordLevel, std::chrono::steady_clock::time_point lastFlush) const {
+            if (buffered >= bufferSize) {
+                return true;
+            }
+            if (flushLevel != Level::Off && recordLevel >= flushLevel) {
+                return true;
+            }
+            return interval.count() > 0 && std::chrono::steady_clock::now() - lastFlush >= interval;
+        }
+    };
+
+    /**
+     * @brief When ConsoleAppender colours its output
+     */
+    enum class ColorMode : neko::uint8 {
+        Auto,   ///< Colour a stream only when it is attached to a terminal
+        Always, ///< Always emit ANSI colour codes
+        Never   ///< Never emit ANSI colour codes
+    };
+
+    /**
+     * @brief How ConsoleAppender hands formatted lines to the OS
+     */
+    enum class ConsoleOutput : neko::uint8 {
+        Stream, ///< Write through std::cout and std::cerr
+        Direct  ///< Write with write(2) to descriptors 1 and 2, bypassing iostreams
+    };
+
+    namespace detail {
+
+        /**
+         * @brief Whether a file descriptor refers to a terminal
+         */
+        inline bool isTerminal([[maybe_unused]] int fd) noexcept {
+#if NEKO_LOG_HAS_FD_IO && defined(_WIN32)
+            return ::_isatty(fd) != 0;
+#elif NEKO_LOG_HAS_FD_IO
+            return ::isatty(fd) != 0;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Write a whole buffer to a file descriptor, resuming after partial writes and interrupts
+         * @return false if the descriptor reported an error or raw output is unavailable
+         * @note Only calls write(2), so it is async-signal-safe on POSIX.
+         */
+        inline bool writeAll([[maybe_unused]] int fd, [[maybe_unused]] const char *data, [[maybe_unused]] std::size_t size) noexcept {
+#if NEKO_LOG_HAS_FD_IO && defined(_WIN32)
+            while (size > 0) {
+                int written = ::_write(fd, data, static_cast<unsigned int>(std::min<std::size_t>(size, 1u << 30)));
+                if (written <= 0) {
+                    return false;
+                }
+                data += written;
+                size -= static_cast<std::size_t>(written);
+            }
+            return true;
+#elif NEKO_LOG_HAS_FD_IO
+            while (size > 0) {
+                auto written = ::write(fd, data, size);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                data += written;
+                size -= static_cast<std::size_t>(written);
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Console appender
+     * @note Consecutive records for the same stream are formatted into one buffer, colour codes included, and written with a
+     *       single call. The buffer is written as soon as a record goes to the other stream, so output keeps the record order
+     *       where standard output and standard error share a terminal. With ColorMode::Auto, colours are used only for streams attached to a terminal (checked when the mode is set).
+     */
+    class ConsoleAppender : public IAppender {
+    private:
+        static constexpr int stdoutFd = 1;
+        static constexpr int stderrFd = 2;
+
+        std::unique_ptr<IFormatter> formatter;
+        ColorMode colorMode = ColorMode::Auto;
+        ConsoleOutput output = ConsoleOutput::Stream;
+        FlushPolicy flushPolicy;
+        bool colorOut = false;
+        bool colorErr = false;
+        bool bannerPending = false;
+        // Pending output, guarded by the mutex
+        std::string out;
+        std::string err;
+        std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+        mutable std::mutex mutex;
+
+        // Caller must hold the mutex
+        void resolveColors() {
+            colorOut = colorMode == ColorMode::Always || (colorMode == ColorMode::Auto && detail::isTerminal(stdoutFd));
+            colorErr = colorMode == ColorMode::Always || (colorMode == ColorMode::Auto && detail::isTerminal(stderrFd));
+        }
+
+        // Caller must hold the mutex
+        void write(std::string &pending, int fd, std::ostream &stream) {
+            if (pending.empty()) {
+                return;
+            }
+            if (output == ConsoleOutput::Direct && NEKO_LOG_HAS_FD_IO) {
+                detail::writeAll(fd, pending.data(), pending.size());
+            } else {
+                stream.write(pending.data(), static_cast<std::streamsize>(pending.size())).flush();
+            }
+            pending.clear();
+        }
+
+        // Caller must hold the mutex
+        void writeBuffers() {
+            write(out, stdoutFd, std::cout);
+            write(err, stderrFd, std::cerr);
+            lastFlush = std::chrono::steady_clock::now();
+        }
+
+    public:
+        explicit ConsoleAppender(std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
+            : formatter(std::move(formatter)) {
+            resolveColors();
+            preOutput();
+        }
+
+        explicit ConsoleAppender(Level level, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
+            : formatter(std::move(formatter)) {
+            setLevel(level);
+            resolveColors();
+            preOutput();
+        }
+
+        /**
+         * @brief Queue the start banner on standard output
+         * @note The banner is written together with the first record, so a logger that never logs to the console
+         *       (such as one whose appenders are replaced at startup) prints nothing.
+         */
+        void preOutput() {
+            std::lock_guard<std::mutex> lock(mutex);
+            bannerPending = true;
+        }
+
+        /**
+         * @brief Set when colour codes are emitted
+         * @note ColorMode::Auto checks whether standard output and standard error are terminals at this point.
+         */
+        void setColorMode(ColorMode mode) {
+            std::lock_guard<std::mutex> lock(mutex);
+            colorMode = mode;
+            resolveColors();
+        }
+
+        ColorMode getColorMode() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return colorMode;
+        }
+
+        /**
+         * @brief Whether lines written to standard output (or standard error) are coloured
+         */
+        bool isColored(bool toStderr = false) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return toStderr ? colorErr : colorOut;
+        }
+
+        /**
+         * @brief Choose between iostreams and raw descriptor writes
+         * @note Anything already buffered is written first. Switching to ConsoleOutput::Direct also flushes std::cout and std::cerr,
+         *       so text the program wrote through them earlier is not overtaken by descriptor writes. After that the appender
+         *       no longer touches iostreams. ConsoleOutput::Direct falls back to iostreams when NEKO_LOG_HAS_FD_IO is 0.
+         */
+        void setOutput(ConsoleOutput mode) {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeBuffers();
+            if (mode == ConsoleOutput::Direct && output != ConsoleOutput::Direct) {
+                std::cout.flush();
+                std::cerr.flush();
+            }
+            output = mode;
+        }
+
+        ConsoleOutput getOutput() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return output;
+        }
+
+        /**
+         * @brief Set the flush policy
+         * @note Anything already buffered is written first. The default flushes after every batch.
+         */
+        void setFlushPolicy(const FlushPolicy &policy) {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeBuffers();
+            flushPolicy = policy;
+            out.reserve(policy.bufferSize);
+        }
+
+        FlushPolicy getFlushPolicy() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return flushPolicy;
+        }
+
+        void append(const LogRecord &record) override {
+            appendBatch(std::span<const LogRecord>(&record, 1));
+        }
+
+        /**
+         * @brief Format the batch in runs per stream, then write what is pending when the flush policy is due
+         * @note A run for one stream is written before the first record for the other one is added, so records keep their order.
+         */
+        void appendBatch(std::span<const LogRecord> records) override {
+            constexpr neko::strview
+                red = "\033[31m",
+                yellow = "\033[33m",
+                blue = "\033[34m",
+                reset = "\033[0m";
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (bannerPending && !records.empty()) {
+                out += "=== ConsoleAppender initialized ===\n=== Level: ";
+                out += levelToString(getLevel());
+                out += " ===\n=== Log Start ===\n";
+                bannerPending = false;
+            }
+            Level highest = Level::Debug;
+            for (const auto &record : records) {
+                neko::strview color;
+                switch (record.level) {
+                    case Level::Debug:
+                        color = blue;
+                        break;
+                    case Level::Info:
+                        color = reset;
+                        break;
+                    case Level::Warn:
+                        color = yellow;
+                        break;
+                    case Level::Error:
+                        color = red;
+                        break;
+                    case Level::Off:
+                        continue;
+                    default:
+                        break;
+                }
+
+                const bool toStderr = record.level == Level::Error;
+                std::string &target = toStderr ? err : out;
+                // Only one stream has pending output at a time
+                if (toStderr) {
+                    write(out, stdoutFd, std::cout);
+                } else {
+                    write(err, stderrFd, std::cerr);
+                }
+                if (!(toStderr ? colorErr : colorOut)) {
+                    color = {};
+                }
+                target.append(color);
+                formatter->formatTo(record, target);
+                if (!color.empty()) {
+                    target.append(reset);
+                }
+                target += '\n';
+                highest = std::max(highest, record.level);
+            }
+
+            if (flushPolicy.due(out.size() + err.size(), highest, lastFlush)) {
+                writeBuffers();
+            }
+        }
+
+        /**
+         * @brief Write pending output; iostreams are only flushed in ConsoleOutput::Stream mode
+         */
+        void flush() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeBuffers();
+            if (output != ConsoleOutput::Direct || !NEKO_LOG_HAS_FD_IO) {
+                std::cout.flush();
+                std::cerr.flush();
+            }
+        }
+
+        bool isThreadSafe() const override {
+            return true;
+        }
+
+        ~ConsoleAppender() {
+            writeBuffers();
+        }
+    };
+
+    /**
+     * @brief File appender
+     * @note Records are collected in an internal buffer and written according to the FlushPolicy. flush() always writes and flushes everything appended so far.
+     */
+    class FileAppender : public IAppender {
+    private:
+        std::unique_ptr<IFormatter> formatter;
+        std::ofstream file;
+        FlushPolicy flushPolicy;
+        std::string buffer;
+        std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+        mutable std::mutex mutex;
+
+        // Caller must hold the mutex
+        void writeBuffer() {
+            if (!buffer.empty()) {
+                file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+            file.flush();
+            lastFlush = std::chrono::steady_clock::now();
+        }
+
+    public:
+        explicit FileAppender(const std::string &filename, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
+            : formatter(std::move(formatter)), file(filename, isTruncate ? std::ios::trunc : std::ios::app) {
+            if (!file.is_open()) {
+                throw neko::ex::FileError("Failed to open log file: " + filename);
+            }
+            preOutput(filename, isTruncate);
+        }
+
+        explicit FileAppender(const std::string &filename, Level level, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
+            : formatter(std::move(formatter)), file(filename, isTruncate ? std::ios::trunc : std::ios::app) {
+            if (!file.is_open()) {
+                throw neko::ex::FileError("Failed to open log file: " + filename);
+            }
+            setLevel(level);
+            preOutput(filename, isTruncate);
+        }
+
+        void preOutput(const std::string &filename, bool isTruncate) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (file.is_open()) {
+                file << "=== FileAppender initialized ===" << std::endl;
+                file << "=== FileName: " << filename << ", Level: " << levelToString(getLevel()) << ", Mode: " << (isTruncate ? "Truncate" : "Append") << " ===" << std::endl;
+                file << "=== Log Start ===" << std::endl;
+            }
+        }
+
+        /**
+         * @brief Set the flush policy
+         * @note Anything already buffered is written first.
+         */
+        void setFlushPolicy(const FlushPolicy &policy) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (file.is_open()) {
+                writeBuffer();
+            }
+            flushPolicy = policy;
+            buffer.reserve(policy.bufferSize);
+        }
+
+        FlushPolicy getFlushPolicy() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return flushPolicy;
+        }
+
+        void append(const LogRecord &record) override {
+            appendBatch(std::span<const LogRecord>(&record, 1));
+        }
+
+        /**
+         * @brief Format the whole batch into the buffer, then apply the flush policy once
+         */
+        void appendBatch(std::span<const LogRecord> records) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!file.is_open() || records.empty()) {
+                return;
+            }
+            Level highest = Level::Debug;
+            for (const auto &record : records) {
+                formatter->formatTo(record, buffer);
+                buffer += '\n';
+                highest = std::max(highest, record.level);
+            }
+            if (flushPolicy.due(buffer.size(), highest, lastFlush)) {
+                writeBuffer();
+            }
+        }
+
+        void flush() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (file.is_open()) {
+                writeBuffer();
+            }
+        }
+
+        bool isThreadSafe() const override {
+            return true;
+        }
+
+        ~FileAppender() {
+            if (file.is_open()) {
+                writeBuffer();
+                file.close();
+            }
+        }
+    };
+
+    /**
+     * @brief Schedule for time-based file rotation
+     */
+    enum class RotationSchedule : neko::uint8 {
+        None,   ///< Rotate by size only
+        Hourly, ///< Rotate at the start of every hour
+        Daily   ///< Rotate at midnight
+    };
+
+    /**
+     * @brief When a rotating appender starts a new file and how many files it keeps
+     */
+    struct RotationPolicy {
+        std::uintmax_t maxFileSize = 0;                     ///< Rotate once the active file reaches this many bytes (0 = no size limit)
+        RotationSchedule schedule = RotationSchedule::None; ///< Time-based rotation
+        std::size_t maxFiles = 0;                           ///< Files to keep, including the active one (0 = keep all)
+        TimeZone timeZone = TimeZone::Local;                ///< Time zone the schedule follows
+    };
+
+    namespace detail {
+
+        /**
+         * @brief First scheduled rotation after a time point
+         */
+        inline std::chrono::system_clock::time_point nextRotationTime(std::chrono::system_clock::time_point tp, RotationSchedule schedule, TimeZone tz) {
+            using namespace std::chrono;
+            if (schedule == RotationSchedule::None) {
+                return system_clock::time_point::max();
+            }
+            if (tz == TimeZone::Utc) {
+                if (schedule == RotationSchedule::Hourly) {
+                    return floor<hours>(tp) + hours(1);
+                }
+                return floor<days>(tp) + days(1);
+            }
+
+            // Let mktime normalise the overflowing field and resolve DST
+            std::tm tm = localTime(system_clock::to_time_t(tp));
+            tm.tm_min = 0;
+            tm.tm_sec = 0;
+            if (schedule == RotationSchedule::Hourly) {
+                tm.tm_hour += 1;
+            } else {
+                tm.tm_hour = 0;
+                tm.tm_mday += 1;
+            }
+            tm.tm_isdst = -1;
+            return system_clock::from_time_t(std::mktime(&tm));
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief File appender that rotates between numbered files
+     * @note For "logs/app.log" the files are "logs/app.1.log", "logs/app.2.log", ... and the highest number is the active one.
+     *       A background thread opens the next file ahead of time under its final name, closes retired files and deletes those
+     *       beyond maxFiles, so rotating on the logging thread only swaps streams. Until that file is ready, records stay in the
+     *       active file and a later record rotates. The prepared file stays empty until it becomes active; an empty newest file
+     *       left behind by a crash is reused by the next appender with the same name.
+     */
+    class RotatingFileAppender : public IAppender {
+    private:
+        using Clock = std::chrono::system_clock;
+        using Stream = std::unique_ptr<std::ofstream>;
+
+        std::unique_ptr<IFormatter> formatter;
+        std::filesystem::path directory;
+        std::string stem;
+        std::string extension;
+        RotationPolicy rotationPolicy;
+
+        // Active file, guarded by mutex
+        Stream file;
+        std::size_t activeIndex = 0;
+        std::uintmax_t fileSize = 0;
+        Clock::time_point nextRotation = Clock::time_point::max();
+        FlushPolicy flushPolicy;
+        std::string buffer;
+        std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+        mutable std::mutex mutex;
+
+        // Background rotation state, guarded by workerMutex
+        Stream prepared;
+        std::size_t preparedIndex = 0;
+        std::size_t nextIndex = 0;
+        bool prepareFailed = false;
+        std::vector<Stream> retired;
+        std::size_t pruneIndex = 0;
+        bool pruneRequested = false;
+        bool stopping = false;
+        std::mutex workerMutex;
+        std::condition_variable workerCondVar;
+        std::thread worker;
+
+        std::filesystem::path pathFor(std::size_t index) const {
+            return directory / (stem + "." + std::to_string(index) + extension);
+        }
+
+        Stream openFile(std::size_t index) const {
+            auto stream = std::make_unique<std::ofstream>(pathFor(index), std::ios::app);
+            if (!stream->is_open()) {
+                return nullptr;
+            }
+            return stream;
+        }
+
+        /**
+         * @brief Parse "<stem>.<digits><suffix>" and return the number
+         */
+        std::optional<std::size_t> parseIndex(std::string_view name, std::string_view suffix) const {
+            const std::string prefix = stem + ".";
+            if (name.size() <= prefix.size() + suffix.size() || !name.starts_with(prefix) || !name.ends_with(suffix)) {
+                return std::nullopt;
+            }
+            const std::string_view digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+            std::size_t index = 0;
+            auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), index);
+            // Also rejects signs and digit runs that do not fit
+            if (ec != std::errc() || end != digits.data() + digits.size()) {
+                return std::nullopt;
+            }
+            return index;
+        }
+
+        /**
+         * @brief Indices of the existing files of this appender, in ascending order
+         */
+        std::vector<std::size_t> existingIndices() const {
+            std::vector<std::size_t> indices;
+            std::error_code ec;
+            for (std::filesystem::directory_iterator it(directory.empty() ? "." : directory, ec), end; !ec && it != end; it.increment(ec)) {
+                if (auto index = parseIndex(it->path().filename().string(), extension)) {
+                    indices.push_back(*index);
+                }
+            }
+            std::sort(indices.begin(), indices.end());
+            return indices;
+        }
+
+        void removeOldFiles(std::size_t keepIndex) const {
+            if (rotationPolicy.maxFiles == 0) {
+                return;
+            }
+            auto indices = existingIndices();
+            indices.erase(std::upper_bound(indices.begin(), indices.end(), keepIndex), indices.end());
+            if (indices.size() <= rotationPolicy.maxFiles) {
+                return;
+            }
+            std::error_code ec;
+            for (std::size_t i = 0; i < indices.size() - rotationPolicy.maxFiles; ++i) {
+                std::filesystem::remove(pathFor(indices[i]), ec);
+            }
+        }
+
+        void workerLoop() {
+            std::unique_lock<std::mutex> lock(workerMutex);
+            while (true) {
+                workerCondVar.wait(lock, [this] {
+                    return stopping || !retired.empty() || pruneRequested || (!prepared && !prepareFailed);
+                });
+                if (stopping && retired.empty() && !pruneRequested) {
+                    break;
+                }
+
+                auto closing = std::move(retired);
+                retired.clear();
+                const bool prune = std::exchange(pruneRequested, false);
+                const std::size_t keepIndex = pruneIndex;
+                const bool prepare = !stopping && !prepared && !prepareFailed;
+                const std::size_t index = prepare ? nextIndex++ : 0;
+
+                lock.unlock();
+                closing.clear();
+                Stream next = prepare ? openFile(index) : nullptr;
+                if (prune) {
+                    removeOldFiles(keepIndex);
+                }
+                lock.lock();
+
+                if (prepare) {
+                    prepared = std::move(next);
+                    preparedIndex = index;
+                    prepareFailed = !prepared;
+                }
+            }
+        }
+
+        // Caller must hold the mutex
+        void writeBuffer() {
+            if (!buffer.empty()) {
+                file->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+            file->flush();
+            lastFlush = std::chrono::steady_clock::now();
+        }
+
+        /**
+         * @brief Switch to the file the worker prepared
+         * @note Caller must hold the mutex. Never waits for the worker: while the next file is still being opened, the current
+         *       one stays active and the next record tries again.
+         */
+        void rotate(Clock::time_point now) {
+            Stream next;
+            std::size_t index = 0;
+            bool failed = false;
+            {
+                std::lock_guard<std::mutex> lock(workerMutex);
+                if (prepared) {
+                    next = std::move(prepared);
+                    index = preparedIndex;
+                } else {
+                    failed = std::exchange(prepareFailed, false);
+                }
+            }
+
+            if (!next) {
+                if (failed) {
+                    // Let the worker try again, and keep the current file for another schedule period or maxFileSize bytes
+                    workerCondVar.notify_one();
+                    fileSize = 0;
+                    nextRotation = detail::nextRotationTime(now, rotationPolicy.schedule, rotationPolicy.timeZone);
+                }
+                return;
+            }
+
+            writeBuffer();
+            {
+                std::lock_guard<std::mutex> lock(workerMutex);
+                retired.push_back(std::move(file));
+                pruneIndex = index;
+                pruneRequested = true;
+            }
+            workerCondVar.notify_one();
+
+            file = std::move(next);
+            activeIndex = index;
+            fileSize = 0;
+            nextRotation = detail::nextRotationTime(now, rotationPolicy.schedule, rotationPolicy.timeZone);
+        }
+
+    public:
+        explicit RotatingFileAppender(const std::string &filename, const RotationPolicy &policy = {}, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
+            : formatter(std::move(formatter)), rotationPolicy(policy) {
+            std::filesystem::path path(filename);
+            directory = path.parent_path();
+            stem = path.stem().string();
+            extension = path.extension().string();
+
+            std::error_code ec;
+            if (!directory.empty()) {
+                std::filesystem::create_directories(directory, ec);
+            }
+
+            // Continue after the newest existing file instead of appending to it, unless it is an unused prepared file
+            auto indices = existingIndices();
+            if (indices.empty()) {
+                activeIndex = 1;
+            } else if (const auto size = std::filesystem::file_size(pathFor(indices.back()), ec); !ec && size == 0) {
+                activeIndex = indices.back();
+            } else {
+                activeIndex = indices.back() + 1;
+            }
+            file = openFile(activeIndex);
+            if (!file) {
+                throw neko::ex::FileError("Failed to open log file: " + pathFor(activeIndex).string());
+            }
+            nextIndex = activeIndex + 1;
+            nextRotation = detail::nextRotationTime(Clock::now(), rotationPolicy.schedule, rotationPolicy.timeZone);
+
+            pruneIndex = activeIndex;
+            pruneRequested = true;
+            worker = std::thread(&RotatingFileAppender::workerLoop, this);
+        }
+
+        explicit RotatingFileAppender(const std::string &filename, Level level, const RotationPolicy &policy = {}, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
+            : RotatingFileAppender(filename, policy, std::move(formatter)) {
+            setLevel(level);
+        }
+
+        RotatingFileAppender(const RotatingFileAppender &) = delete;
+        RotatingFileAppender &operator=(const RotatingFileAppender &) = delete;
+
+        /**
+         * @brief Set the flush policy
+         * @note Anything already buffered is written first.
+         */
+        void setFlushPolicy(const FlushPolicy &policy) {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeBuffer();
+            flushPolicy = policy;
+            buffer.reserve(policy.bufferSize);
+        }
+
+        FlushPolicy getFlushPolicy() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return flushPolicy;
+        }
+
+        /**
+         * @brief Path of the file currently written to
+         */
+        std::filesystem::path getActivePath() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return pathFor(activeIndex);
+        }
+
+        void append(const LogRecord &record) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (record.timestamp >= nextRotation ||
+                (rotationPolicy.maxFileSize > 0 && fileSize >= rotationPolicy.maxFileSize)) {
+                rotate(record.timestamp);
+            }
+
+            const std::size_t before = buffer.size();
+            formatter->formatTo(record, buffer);
+            buffer += '\n';
+            fileSize += buffer.size() - before;
+            if (flushPolicy.due(buffer.size(), record.level, lastFlush)) {
+                writeBuffer();
+            }
+        }
+
+        void flush() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeBuffer();
+        }
+
+        bool isThreadSafe() const override {
+            return true;
+        }
+
+        ~RotatingFileAppender() {
+            {
+                std::lock_guard<std::mutex> lock(workerMutex);
+                stopping = true;
+            }
+            workerCondVar.notify_one();
+            if (worker.joinable()) {
+                worker.join();
+            }
+
+            writeBuffer();
+            file->close();
+
+            // The prepared file was never written to
+            if (prepared) {
+                prepared->close();
+                std::error_code ec;
+                std::filesystem::remove(pathFor(preparedIndex), ec);
+            }
+        }
+    };
+
+#if NEKO_LOG_HAS_MMAP
+    /**
+     * @brief File appender writing through a memory mapping
+     * @note The file is extended and mapped one window at a time and formatted records are copied straight into the mapping,
+     *       so appending makes no system calls until a window fills up. Each window's disk blocks are allocated before it is
+     *       mapped; if that fails (e.g. the disk is full) records are dropped and the next append tries again. On close the file
+     *       is truncated to the bytes written; after a crash the last window may end with zero bytes. POSIX only (NEKO_LOG_HAS_MMAP).
+     */
+    class MmapFileAppender : public IAppender {
+    private:
+        std::unique_ptr<IFormatter> formatter;
+        std::string filename;
+        int fd = -1;
+        std::size_t windowSize = 0;
+        char *window = nullptr;
+        std::uint64_t windowOffset = 0; // File offset of the mapped window
+        std::size_t windowPos = 0;      // Bytes written into the window
+        std::string line;               // Reused formatting buffer, guarded by the mutex
+        mutable std::mutex mutex;
+
+        /**
+         * @brief Allocate the disk blocks of the window past the bytes already written
+         * @note Stores into a sparse hole raise SIGBUS when the disk is full, so the space has to exist before it is mapped.
+         *       Caller must hold the mutex.
+         */
+        bool reserveWindow() {
+            const auto begin = static_cast<off_t>(windowOffset + windowPos);
+            const auto end = static_cast<off_t>(windowOffset + windowSize);
+#if !defined(__APPLE__)
+            const int result = ::posix_fallocate(fd, begin, end - begin);
+            if (result != EINVAL && result != EOPNOTSUPP) {
+                return result == 0;
+            }
+#endif
+            // No fallocate for this file system: write the zeros ourselves
+            static constexpr char zeros[4096]{};
+            for (off_t offset = begin; offset < end;) {
+                const auto chunk = static_cast<std::size_t>(std::min<off_t>(end - offset, sizeof(zeros)));
+                const ssize_t written = ::pwrite(fd, zeros, chunk, offset);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written <= 0) {
+                    return false;
+                }
+                offset += written;
+            }
+            return true;
+        }
+
+        // Caller must hold the mutex
+        bool mapWindow() {
+            if (!reserveWindow()) {
+                return false;
+            }
+            void *mapping = ::mmap(nullptr, windowSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(windowOffset));
+            if (mapping == MAP_FAILED) {
+                return false;
+            }
+            window = static_cast<char *>(mapping);
+            return true;
+        }
+
+        // Caller must hold the mutex
+        void unmapWindow(int syncFlags) {
+            if (window) {
+                ::msync(window, windowSize, syncFlags);
+                ::munmap(window, windowSize);
+                window = nullptr;
+            }
+        }
+
+        // Caller must hold the mutex
+        bool rollWindow() {
+            unmapWindow(MS_ASYNC);
+            windowOffset += windowSize;
+            windowPos = 0;
+            return mapWindow();
+        }
+
+        void openFile(bool isTruncate, std::size_t requestedWindowSize) {
+            fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (isTruncate ? O_TRUNC : 0), 0644);
+            if (fd < 0) {
+                throw neko::ex::FileError("Failed to open log file: " + filename);
+            }
+
+            const auto fail = [this](const std::string &message) {
+                ::close(fd);
+                fd = -1;
+                throw neko::ex::FileError(message + filename);
+            };
+
+            // Mappings start on page boundaries, so the window is a whole number of pages
+            const long page = ::sysconf(_SC_PAGESIZE);
+            if (page <= 0) {
+                fail("Failed to query the page size for log file: ");
+            }
+            const auto pageSize = static_cast<std::size_t>(page);
+            windowSize = (std::max(requestedWindowSize, pageSize) + pageSize - 1) / pageSize * pageSize;
+
+            // Continue after the existing content
+            struct stat info {};
+            if (::fstat(fd, &info) != 0) {
+                fail("Failed to stat log file: ");
+            }
+            const auto size = static_cast<std::uint64_t>(info.st_size);
+            windowOffset = size / pageSize * pageSize;
+            windowPos = static_cast<std::size_t>(size - windowOffset);
+            if (!mapWindow()) {
+                fail("Failed to map log file: ");
+            }
+        }
+
+        // Caller must hold the mutex
+        void copyToWindow(const char *data, std::size_t size) {
+            // A window that could not be reserved earlier is retried, so logging resumes once space is available
+            if (!window && !mapWindow()) {
+                return;
+            }
+            while (size > 0) {
+                if (windowPos == windowSize && !rollWindow()) {
+                    return;
+                }
+                const std::size_t chunk = std::min(size, windowSize - windowPos);
+                std::memcpy(window + windowPos, data, chunk);
+                windowPos += chunk;
+                data += chunk;
+                size -= chunk;
+            }
+        }
+
+    public:
+        static constexpr std::size_t defaultWindowSize = 4 * 1024 * 1024;
+
+        explicit MmapFileAppender(const std::string &filename, bool isTruncate = false, std::size_t windowSize = defaultWindowSize, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
+            : formatter(std::move(formatter)), filename(filename) {
+            openFile(isTruncate, windowSize);
+        }
+
+        explicit MmapFileAppender(const std::string &filename, Level level, bool isTruncate = false, std::size_t windowSize = defaultWindowSize, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
+            : formatter(std::move(formatter)), filename(filename) {
+            setLevel(level);
+            openFile(isTruncate, windowSize);
+        }
+
+        MmapFileAppender(const MmapFileAppender &) = delete;
+        MmapFileAppender &operator=(const MmapFileAppender &) = delete;
+
+        std::size_t getWindowSize() const {
+            return windowSize;
+        }
+
+        void append(const LogRecord &record) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            line.clear();
+            formatter->formatTo(record, line);
+            line += '\n';
+            copyToWindow(line.data(), line.size());
+        }
+
+        /**
+         * @brief Schedule write-back of the current window
+         * @note Bytes are visible to readers of the file as soon as they are appended; this only starts writing them to disk.
+         */
+        void flush() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (window && windowPos > 0) {
+                ::msync(window, windowSize, MS_ASYNC);
+            }
+        }
+
+        bool isThreadSafe() const override {
+            return true;
+        }
+
+        ~MmapFileAppender() {
+            if (fd >= 0) {
+                unmapWindow(MS_SYNC);
+                ::ftruncate(fd, static_cast<off_t>(windowOffset + windowPos));
+                ::close(fd);
+            }
+        }
+    };
+#endif // NEKO_LOG_HAS_MMAP
+
+    namespace detail::binary {
+
+        /**
+         * @brief Binary log layout
+         * @note A file is a sequence of segments. Each segment starts with the magic "NLOG" and a version byte,
+         *       followed by frames of [type: u8][payload size: varint][payload]. Interned ids and the timestamp
+         *       base restart with every segment, so appending to an existing file just starts a new one.
+         *
+         *       Thread / File frame: [id: varint][name bytes]
+         *       Record frame:        [timestamp delta in ns: zigzag varint][level: u8][thread id: varint][file id: varint][line: varint][message bytes]
+         */
+        inline constexpr std::array<char, 4> magic{'N', 'L', 'O', 'G'};
+        inline constexpr neko::uint8 version = 1;
+
+        /**
+         * @brief Largest frame a reader accepts from a stream whose end it cannot determine
+         */
+        inline constexpr std::uint64_t maxUncheckedFrameSize = 64 * 1024 * 1024;
+
+        enum class FrameType : neko::uint8 {
+            Thread = 1, ///< Interns a thread name
+            File = 2,   ///< Interns a source file name
+            Record = 3  ///< A log record
+        };
+
+        inline void putVarint(std::string &out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out += static_cast<char>((value & 0x7F) | 0x80);
+                value >>= 7;
+            }
+            out += static_cast<char>(value);
+        }
+
+        inline bool getVarint(std::string_view &in, std::uint64_t &value) noexcept {
+            value = 0;
+            for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+                const auto byte = static_cast<unsigned char>(in.front());
+                in.remove_prefix(1);
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        constexpr std::uint64_t zigzag(std::int64_t value) noexcept {
+            return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+        }
+
+        constexpr std::int64_t unzigzag(std::uint64_t value) noexcept {
+            return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+        }
+
+        inline std::int64_t toNanoseconds(std::chrono::system_clock::time_point tp) noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+        }
+
+    } // namespace detail::binary
+
+    /**
+     * @brief Appender writing records in a compact binary format
+     * @note No text formatting is done: timestamps are varint deltas, thread and source file names are written once per segment
+     *       and referenced by id, and the message bytes are stored as is. Frames are only ever appended whole, so a file cut short
+     *       by a crash reads back up to its last complete frame. Use BinaryLogReader or the nlog-decode tool to turn it back into text.
+     *       Structured fields (LogRecord::fields) are not part of the format and are dropped.
+     */
+    class BinaryAppender : public IAppender {
+    private:
+        std::ofstream file;
+        FlushPolicy flushPolicy;
+        std::string buffer;
+        std::string payload;
+        std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+        std::unordered_map<std::string, neko::uint32, detail::StringHash, std::equal_to<>> threadIds;
+        std::unordered_map<neko::cstr, neko::uint32> fileIds;
+        std::int64_t lastTimestamp = 0;
+        mutable std::mutex mutex;
+
+        void openFile(const std::string &filename, bool isTruncate) {
+            file.open(filename, std::ios::binary | (isTruncate ? std::ios::trunc : std::ios::app));
+            if (!file.is_open()) {
+                throw neko::ex::FileError("Failed to open log file: " + filename);
+            }
+            buffer.append(detail::binary::magic.data(), detail::binary::magic.size());
+            buffer += static_cast<char>(detail::binary::version);
+            writeBuffer();
+        }
+
+        // Caller must hold the mutex
+        void writeFrame(detail::binary::FrameType type) {
+            buffer += static_cast<char>(type);
+            detail::binary::putVarint(buffer, payload.size());
+            buffer += payload;
+        }
+
+        // Caller must hold the mutex
+        template <typename Map, typename Key>
+        neko::uint32 intern(Map &ids, const Key &key, std::string_view name, detail::binary::FrameType type) {
+            if (auto it = ids.find(key); it != ids.end()) {
+                return it->second;
+            }
+            const auto id = static_cast<neko::uint32>(ids.size());
+            ids.emplace(key, id);
+            payload.clear();
+            detail::binary::putVarint(payload, id);
+            payload += name;
+            writeFrame(type);
+            return id;
+        }
+
+        // Caller must hold the mutex
+        void writeBuffer() {
+            if (!buffer.empty()) {
+                file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+            file.flush();
+            lastFlush = std::chrono::steady_clock::now();
+        }
+
+    public:
+        explicit BinaryAppender(const std::string &filename, bool isTruncate = false) {
+            openFile(filename, isTruncate);
+        }
+
+        explicit BinaryAppender(const std::string &filename, Level level, bool isTruncate = false) {
+            setLevel(level);
+            openFile(filename, isTruncate);
+        }
+
+        /**
+         * @brief Set the flush policy
+         * @note Anything already buffered is written first.
+         */
+        void setFlushPolicy(const FlushPolicy &policy) {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeBuffer();
+            flushPolicy = policy;
+            buffer.reserve(policy.bufferSize);
+        }
+
+        FlushPolicy getFlushPolicy() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return flushPolicy;
+        }
+
+        void append(const LogRecord &record) override {
+            using namespace detail::binary;
+            neko::cstr fileName = record.location.getFile();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            const neko::uint32 threadId = intern(threadIds, record.threadName.view(), record.threadName.view(), FrameType::Thread);
+            const neko::uint32 fileId = intern(fileIds, fileName, fileName, FrameType::File);
+
+            const std::int64_t timestamp = toNanoseconds(record.timestamp);
+            payload.clear();
+            putVarint(payload, zigzag(timestamp - lastTimestamp));
+            payload += static_cast<char>(record.level);
+            putVarint(payload, threadId);
+            putVarint(payload, fileId);
+            putVarint(payload, record.location.getLine());
+            payload += record.message;
+            writeFrame(FrameType::Record);
+            lastTimestamp = timestamp;
+
+            if (flushPolicy.due(buffer.size(), record.level, lastFlush)) {
+                writeBuffer();
+            }
+        }
+
+        void flush() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeBuffer();
+        }
+
+        bool isThreadSafe() const override {
+            return true;
+        }
+
+        ~BinaryAppender() {
+            if (file.is_open()) {
+                writeBuffer();
+                file.close();
+            }
+        }
+    };
+
+    /**
+     * @brief Reads records written by BinaryAppender
+     */
+    class BinaryLogReader {
+    public:
+        /**
+         * @brief A decoded record
+         * @note threadName and file point into the reader and stay valid for its lifetime.
+         */
+        struct Entry {
+            Level level = Level::Info;
+            std::chrono::system_clock::time_point timestamp;
+            std::string_view threadName;
+            neko::cstr file = "";
+            neko::uint32 line = 0;
+            std::string message;
+        };
+
+    private:
+        std::istream &in;
+        std::deque<std::string> names; // Stable storage for every interned name
+        std::vector<const std::string *> threads;
+        std::vector<const std::string *> files;
+        std::int64_t lastTimestamp = 0;
+        std::string payload;
+        std::uint64_t streamEnd = 0; // Last measured end of a seekable stream
+        bool incomplete = false;
+
+        /**
+         * @brief Read a segment header
+         * @param first Whether this is the header at the start of the stream
+         * @return false, marking the log incomplete, if the header was cut short (or is damaged after the first segment)
+         */
+        bool readSegmentHeader(bool first) {
+            std::array<char, detail::binary::magic.size() + 1> header{};
+            in.read(header.data(), header.size());
+            const auto read = static_cast<std::size_t>(in.gcount());
+            const std::size_t magicRead = std::min(read, detail::binary::magic.size());
+            const bool magicMatches = std::equal(detail::binary::magic.begin(), detail::binary::magic.begin() + magicRead, header.begin());
+            if (first && !magicMatches) {
+                throw neko::ex::FileError("Not a binary log file");
+            }
+            if (read != header.size() || !magicMatches) {
+                incomplete = true;
+                return false;
+            }
+            if (static_cast<neko::uint8>(header.back()) != detail::binary::version) {
+                throw neko::ex::FileError("Unsupported binary log version: " + std::to_string(static_cast<neko::uint8>(header.back())));
+            }
+            threads.clear();
+            files.clear();
+            lastTimestamp = 0;
+            return true;
+        }
+
+        /**
+         * @brief Whether size more bytes can follow in the stream
+         * @note Checked against the end of a seekable stream, measured again if the file has grown; otherwise against
+         *       maxUncheckedFrameSize.
+         */
+        bool fits(std::uint64_t size) {
+            const std::streamoff pos = in.tellg();
+            if (pos < 0) {
+                return size <= detail::binary::maxUncheckedFrameSize;
+            }
+            const auto offset = static_cast<std::uint64_t>(pos);
+            if (offset <= streamEnd && size <= streamEnd - offset) {
+                return true;
+            }
+            in.seekg(0, std::ios::end);
+            const std::streamoff end = in.tellg();
+            in.seekg(pos);
+            if (end < 0) {
+                return size <= detail::binary::maxUncheckedFrameSize;
+            }
+            streamEnd = static_cast<std::uint64_t>(end);
+            return offset <= streamEnd && size <= streamEnd - offset;
+        }
+
+        // Reads the payload of the next frame, false at the end of the file or an incomplete or damaged frame
+        bool readPayload(std::uint64_t size) {
+            // A size read from a damaged frame must not turn into a huge allocation; small frames are not worth a seek
+            if (size > 64 * 1024 && !fits(size)) {
+                incomplete = true;
+                return false;
+            }
+            payload.resize(static_cast<std::size_t>(size));
+            in.read(payload.data(), static_cast<std::streamsize>(size));
+            if (in.gcount() != static_cast<std::streamsize>(size)) {
+                incomplete = true;
+                return false;
+            }
+            return true;
+        }
+
+        bool readFrameSize(std::uint64_t &size) {
+            size = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const int byte = in.get();
+                if (byte == std::char_traits<char>::eof()) {
+                    incomplete = true;
+                    return false;
+                }
+                size |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            incomplete = true;
+            return false;
+        }
+
+        void internName(std::vector<const std::string *> &table, std::string_view data) {
+            std::uint64_t id;
+            if (!detail::binary::getVarint(data, id)) {
+                return;
+            }
+            if (table.size() <= id) {
+                table.resize(id + 1, nullptr);
+            }
+            table[id] = &names.emplace_back(data);
+        }
+
+        static const std::string *lookup(const std::vector<const std::string *> &table, std::uint64_t id) {
+            static const std::string unknown = "?";
+            return id < table.size() && table[id] ? table[id] : &unknown;
+        }
+
+    public:
+        /**
+         * @brief Start reading a binary log
+         * @throws neko::ex::FileError if the stream does not start with a binary log header
+         * @note A header cut short, as in a file that crashed before its first frame, reads as an incomplete empty log.
+         */
+        explicit BinaryLogReader(std::istream &in) : in(in) {
+            readSegmentHeader(true);
+        }
+
+        BinaryLogReader(const BinaryLogReader &) = delete;
+        BinaryLogReader &operator=(const BinaryLogReader &) = delete;
+
+        /**
+         * @brief Read the next record
+         * @return false at the end of the log, or at a frame or segment header that is cut short or damaged (see isIncomplete)
+         */
+        bool next(Entry &entry) {
+            using namespace detail::binary;
+            while (true) {
+                const int type = in.peek();
+                if (type == std::char_traits<char>::eof()) {
+                    return false;
+                }
+                if (type == magic.front()) {
+                    if (!readSegmentHeader(false)) {
+                        return false;
+                    }
+                    continue;
+                }
+                in.get();
+
+                std::uint64_t size;
+                if (!readFrameSize(size) || !readPayload(size)) {
+                    return false;
+                }
+
+                switch (static_cast<FrameType>(type)) {
+                    case FrameType::Thread:
+                        internName(threads, payload);
+                        break;
+                    case FrameType::File:
+                        internName(files, payload);
+                        break;
+                    case FrameType::Record: {
+                        std::string_view data = payload;
+                        std::uint64_t delta, threadId, fileId, line;
+                        if (!getVarint(data, delta) || data.empty()) {
+                            break;
+                        }
+                        const auto level = static_cast<Level>(data.front());
+                        data.remove_prefix(1);
+                        if (!getVarint(data, threadId) || !getVarint(data, fileId) || !getVarint(data, line)) {
+                            break;
+                        }
+
+                        lastTimestamp += unzigzag(delta);
+                        entry.level = level;
+                        entry.timestamp = std::chrono::system_clock::time_point(
+                            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(lastTimestamp)));
+                        entry.threadName = *lookup(threads, threadId);
+                        entry.file = lookup(files, fileId)->c_str();
+                        entry.line = static_cast<neko::uint32>(line);
+                        entry.message.assign(data);
+                        return true;
+                    }
+                    default:
+                        // Unknown frame types from newer writers are skipped
+                        break;
+                }
+            }
+        }
+
+        /**
+         * @brief Whether reading stopped at an incomplete frame
+         */
+        bool isIncomplete() const {
+            return incomplete;
+        }
+    };
+
+    /**
+     * @brief Counters of an AsyncAppender
+     */
+    struct AsyncAppenderStats {
+        std::uint64_t enqueued = 0;           ///< Records accepted into the queue
+        std::uint64_t written = 0;            ///< Records handed to the wrapped appender
+        std::uint64_t dropped = 0;            ///< Records dropped by the overflow policy
+        std::uint64_t pending = 0;            ///< Records waiting in the queue
+        std::chrono::nanoseconds lastLag{0};  ///< Time from logging to writing for the most recent batch
+        std::chrono::nanoseconds maxLag{0};   ///< Largest lag seen so far
+    };
+
+    /**
+     * @brief Runs another appender on its own queue and worker thread
+     * @note append() only copies the record into the queue, so a slow or blocked sink no longer holds up the other appenders.
+     *       Each AsyncAppender has its own overflow policy; give slow sinks a dropping policy so they fall behind on their own.
+     *       The wrapped appender's level is taken over by this appender.
+     */
+    class AsyncAppender : public IAppender {
+    private:
+        std::unique_ptr<IAppender> appender;
+        detail::BoundedQueue<LogRecord> queue;
+        OverflowPolicy overflowPolicy;
+        Level overflowLevel;
+        std::size_t maxBatchSize;
+
+        std::atomic<std::uint64_t> enqueued = 0;
+        std::atomic<std::uint64_t> written = 0;
+        std::atomic<std::uint64_t> evicted = 0; // Dropped after being queued (DropOldest)
+        std::atomic<std::uint64_t> dropped = 0;
+        std::atomic<std::uint64_t> unreportedDrops = 0;
+        std::atomic<std::int64_t> lastLag = 0; // Nanoseconds
+        std::atomic<std::int64_t> maxLag = 0;  // Nanoseconds
+
+        std::atomic<bool> stopping = false;
+        detail::ConsumerParking parking;
+        std::mutex flushMutex;
+        std::condition_variable flushCondVar;
+        // Held around calls into the wrapped appender unless it is thread-safe, flush() runs on the caller's thread
+        std::mutex sinkMutex;
+        bool serializeSink;
+        std::thread worker;
+
+        template <typename Call>
+        void callSink(Call &&call) {
+            if (serializeSink) {
+                std::lock_guard<std::mutex> lock(sinkMutex);
+                call(*appender);
+            } else {
+                call(*appender);
+            }
+        }
+
+        void push(const LogRecord &record) {
+            auto onDrop = [this] {
+                if (overflowPolicy == OverflowPolicy::DropOldest) {
+                    evicted.fetch_add(1, std::memory_order_relaxed);
+                }
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                unreportedDrops.fetch_add(1, std::memory_order_relaxed);
+            };
+            // Copy-assigning into the slot reuses the message buffer of the record that last used it
+            auto tryPush = [this, &record] {
+                return queue.tryEmplace([&record](LogRecord &slot) { slot = record; });
+            };
+            if (detail::pushWithPolicy(queue, tryPush, record.level, overflowPolicy, overflowLevel, onDrop)) {
+                enqueued.fetch_add(1, std::memory_order_relaxed);
+                parking.wake();
+            }
+        }
+
+        void recordLag(const LogRecord &record) {
+            const std::int64_t lag = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::system_clock::now() - record.timestamp)
+                                         .count();
+            lastLag.store(lag, std::memory_order_relaxed);
+            std::int64_t previous = maxLag.load(std::memory_order_relaxed);
+            while (lag > previous && !maxLag.compare_exchange_weak(previous, lag, std::memory_order_relaxed)) {
+            }
+        }
+
+        // Returns false once the queue is empty
+        bool writeBatch(std::vector<LogRecord> &batch) {
+            std::size_t count = 0;
+            while (count < maxBatchSize && queue.tryConsume([&batch, count](LogRecord &slot) {
+                       if (count == batch.size()) {
+                           batch.emplace_back();
+                       }
+                       batch[count] = slot;
+                   })) {
+                ++count;
+            }
+            if (count == 0) {
+                return false;
+            }
+
+            callSink([&batch, count](IAppender &sink) { sink.appendBatch(std::span<const LogRecord>(batch.data(), count)); });
+            recordLag(batch[count - 1]);
+            if (queue.empty()) {
+                // Report before publishing progress, so flush() also covers the summary
+                reportDrops();
+            }
+            written.fetch_add(count, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(flushMutex);
+            }
+            flushCondVar.notify_all();
+            return true;
+        }
+
+        void reportDrops() {
+            if (unreportedDrops.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+            const std::uint64_t count = unreportedDrops.exchange(0, std::memory_order_relaxed);
+            if (count > 0) {
+                const LogRecord notice(Level::Warn, std::format("{} log records dropped, the appender queue was full", count));
+                callSink([&notice](IAppender &sink) { sink.append(notice); });
+            }
+        }
+
+        void run(const std::string &threadName) {
+            if (!threadName.empty()) {
+                threadNameManager.setCurrentThreadName(threadName);
+            }
+            std::vector<LogRecord> batch;
+            detail::prepareBatch(batch, maxBatchSize);
+            const auto ready = [this] {
+                return !queue.empty() || stopping.load(std::memory_order_relaxed);
+            };
+            bool unflushed = false;
+            while (!stopping.load(std::memory_order_acquire)) {
+                if (writeBatch(batch)) {
+                    unflushed = true;
+                    continue;
+                }
+                reportDrops();
+                if (!unflushed) {
+                    parking.wait(ready);
+                } else if (!parking.wait(ready, detail::idleFlushDelay)) {
+                    callSink([](IAppender &sink) { sink.flushIdle(); });
+                    unflushed = false;
+                }
+            }
+            while (writeBatch(batch)) {
+            }
+            reportDrops();
+            callSink([](IAppender &sink) { sink.flush(); });
+        }
+
+    public:
+        /**
+         * @brief Wrap an appender
+         * @param options Queue capacity, overflow policy, batch size and worker thread name
+         */
+        explicit AsyncAppender(std::unique_ptr<IAppender> appender, const AsyncOptions &options = {})
+            : appender(std::move(appender)), queue(options.queueCapacity),
+              overflowPolicy(options.overflowPolicy), overflowLevel(options.overflowLevel),
+              maxBatchSize(std::max<std::size_t>(options.maxBatchSize, 1)), serializeSink(!this->appender->isThreadSafe()) {
+            if (!this->appender->shouldUseLoggerLevel()) {
+                setLevel(this->appender->getLevel());
+            }
+            worker = std::thread([this, name = options.threadName] { run(name); });
+        }
+
+        AsyncAppender(const AsyncAppender &) = delete;
+        AsyncAppender &operator=(const AsyncAppender &) = delete;
+
+        void append(const LogRecord &record) override {
+            push(record);
+        }
+
+        void appendBatch(std::span<const LogRecord> records) override {
+            for (const auto &record : records) {
+                push(record);
+            }
+        }
+
+        /**
+         * @brief Wait until every record appended so far has been written, then flush the wrapped appender
+         */
+        void flush() override {
+            const std::uint64_t target = enqueued.load(std::memory_order_relaxed);
+            {
+                // Evictions do not notify, so re-check periodically
+                std::unique_lock<std::mutex> lock(flushMutex);
+                while (!flushCondVar.wait_for(lock, std::chrono::milliseconds(10), [this, target] {
+                    return written.load(std::memory_order_acquire) + evicted.load(std::memory_order_relaxed) >= target;
+                })) {
+                }
+            }
+            callSink([](IAppender &sink) { sink.flush(); });
+        }
+
+        /**
+         * @brief Nothing to do, the worker flushes the wrapped appender when its own queue goes idle
+         */
+        void flushIdle() override {}
+
+        bool isThreadSafe() const override {
+            return true;
+        }
+
+        AsyncAppenderStats getStats() const {
+            AsyncAppenderStats stats;
+            stats.written = written.load(std::memory_order_relaxed);
+            stats.dropped = dropped.load(std::memory_order_relaxed);
+            const std::uint64_t done = stats.written + evicted.load(std::memory_order_relaxed);
+            stats.enqueued = enqueued.load(std::memory_order_relaxed);
+            stats.pending = stats.enqueued > done ? stats.enqueued - done : 0;
+            stats.lastLag = std::chrono::nanoseconds(lastLag.load(std::memory_order_relaxed));
+            stats.maxLag = std::chrono::nanoseconds(maxLag.load(std::memory_order_relaxed));
+            return stats;
+        }
+
+        /**
+         * @brief The wrapped appender
+         */
+        IAppender &getAppender() const {
+            return *appender;
+        }
+
+        ~AsyncAppender() {
+            parking.notify([this] { stopping.store(true, std::memory_order_release); });
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    };
+
+    /**
+     * @brief Collapses consecutive repeats of a record before they reach another appender
+     * @note Records are repeats when level, call site, message and fields match. Repeats within the window of the first
+     *       record of a run are suppressed and later summarised by one "last message repeated N times" record.
+     *       There is no timer: the summary is written by the next record that is not suppressed (a different record,
+     *       or a repeat after the window), by flush() or by the destructor.
+     *       The wrapped appender's level is taken over by this appender.
+     */
+    class DedupAppender : public IAppender {
+    private:
+        std::unique_ptr<IAppender> appender;
+        std::chrono::nanoseconds window;
+
+        // Current run, guarded by the mutex
+        bool hasLast = false;
+        std::size_t lastHash = 0;
+        LogRecord last;
+        std::chrono::system_clock::time_point runStart;
+        std::chrono::system_clock::time_point lastRepeat;
+        std::uint64_t repeats = 0;
+        LogRecord summary;
+
+        std::atomic<std::uint64_t> suppressedCount = 0;
+        mutable std::mutex mutex;
+
+        static std::size_t hashRecord(const LogRecord &record) noexcept {
+            std::size_t hash = std::hash<std::string_view>{}(record.message);
+            hash ^= std::hash<const void *>{}(record.location.getFile()) + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+            hash ^= (static_cast<std::size_t>(record.location.getLine()) << 8) | static_cast<std::size_t>(record.level);
+            for (const auto &field : record.fields) {
+                hash ^= std::hash<std::string_view>{}(field.key) + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+                hash ^= std::hash<FieldValue>{}(field.value) + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+            }
+            return hash;
+        }
+
+        static bool sameFields(const std::vector<Field> &lhs, const std::vector<Field> &rhs) noexcept {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const Field &a, const Field &b) {
+                return a.key == b.key && a.value == b.value;
+            });
+        }
+
+        bool isRepeat(const LogRecord &record, std::size_t hash) const noexcept {
+            return hasLast && hash == lastHash && record.level == last.level &&
+                   record.location.getFile() == last.location.getFile() &&
+                   record.location.getLine() == last.location.getLine() &&
+                   record.message == last.message &&
+                   sameFields(record.fields, last.fields) &&
+                   record.timestamp - runStart <= window;
+        }
+
+        // Caller must hold the mutex
+        void writeSummary() {
+            if (repeats == 0) {
+                return;
+            }
+            summary = last;
+            summary.fields.clear();
+            summary.timestamp = lastRepeat;
+            summary.message.clear();
+            std::format_to(std::back_inserter(summary.message), "last message repeated {} {}", repeats, repeats == 1 ? "time" : "times");
+            repeats = 0;
+            appender->append(summary);
+        }
+
+        // Caller must hold the mutex; returns false if the record is suppressed
+        bool admit(const LogRecord &record) {
+            const std::size_t hash = hashRecord(record);
+            if (isRepeat(record, hash)) {
+                ++repeats;
+                lastRepeat = record.timestamp;
+                suppressedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            writeSummary();
+            hasLast = true;
+            lastHash = hash;
+            last = record;
+            runStart = record.timestamp;
+            return true;
+        }
+
+    public:
+        /**
+         * @brief Wrap an appender
+         * @param window Repeats are collapsed for this long after the first record of a run
+         */
+        explicit DedupAppender(std::unique_ptr<IAppender> appender, std::chrono::nanoseconds window = std::chrono::seconds(10))
+            : appender(std::move(appender)), window(window) {
+            if (!this->appender->shouldUseLoggerLevel()) {
+                setLevel(this->appender->getLevel());
+            }
+        }
+
+        void append(const LogRecord &record) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (admit(record)) {
+                appender->append(record);
+            }
+        }
+
+        /**
+         * @brief Hand runs of admitted records to the wrapped appender as batches
+         */
+        void appendBatch(std::span<const LogRecord> records) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            // A summary is only written right after a suppressed record, when nothing of the batch is pending,
+            // so it always lands in order
+            std::size_t begin = 0;
+            for (std::size_t i = 0; i < records.size(); ++i) {
+                if (!admit(records[i])) {
+                    if (i > begin) {
+                        appender->appendBatch(records.subspan(begin, i - begin));
+                    }
+                    begin = i + 1;
+                }
+            }
+            if (records.size() > begin) {
+                appender->appendBatch(records.subspan(begin));
+            }
+        }
+
+        /**
+         * @brief Write the summary of a pending run, then flush the wrapped appender
+         */
+        void flush() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeSummary();
+            appender->flush();
+        }
+
+        /**
+         * @brief Flush the wrapped appender, keeping a pending run open
+         */
+        void flushIdle() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            appender->flushIdle();
+        }
+
+        bool isThreadSafe() const override {
+            return true;
+        }
+
+        /**
+         * @brief Total number of records suppressed as repeats
+         */
+        std::uint64_t getSuppressedCount() const noexcept {
+            return suppressedCount.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief The wrapped appender
+         */
+        IAppender &getAppender() const {
+            return *appender;
+        }
+
+        ~DedupAppender() {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeSummary();
+        }
+    };
+
+    namespace detail {
+
+#if NEKO_LOG_HAS_CRASH_HANDLER
+        /**
+         * @brief Give the calling thread an alternate signal stack, unless it already has one
+         * @note A handler installed with SA_ONSTACK only leaves the faulting stack when the thread has one,
+         *       which is what lets it run after a stack overflow. The stack is released when the thread exits.
+         */
+        inline bool installAltStack() noexcept {
+            struct AltStack {
+                std::unique_ptr<char[]> memory;
+
+                ~AltStack() {
+                    stack_t current{};
+                    if (memory && ::sigaltstack(nullptr, &current) == 0 && current.ss_sp == memory.get()) {
+                        stack_t disable{};
+                        disable.ss_flags = SS_DISABLE;
+                        ::sigaltstack(&disable, nullptr);
+                    }
+                }
+            };
+            static thread_local AltStack altStack;
+
+            stack_t current{};
+            if (::sigaltstack(nullptr, &current) == 0 && (current.ss_flags & SS_DISABLE) == 0) {
+                return true;
+            }
+            const std::size_t size = std::max<std::size_t>(SIGSTKSZ, 64 * 1024);
+            altStack.memory.reset(new (std::nothrow) char[size]);
+            if (!altStack.memory) {
+                return false;
+            }
+            stack_t stack{};
+            stack.ss_sp = altStack.memory.get();
+            stack.ss_size = size;
+            if (::sigaltstack(&stack, nullptr) != 0) {
+                altStack.memory.reset();
+                return false;
+            }
+            return true;
+        }
+#endif
+
+        /**
+         * @brief Writes async records to pre-opened descriptors through a buffer allocated up front
+         * @note Meant for a fatal signal handler: it never allocates or locks and only calls write(2),
+         *       std::to_chars and calendar arithmetic. Timestamps are written in UTC, since converting
+         *       to local time is not async-signal-safe. Deferred messages are rendered from their captured
+         *       arguments with the format specs ignored.
+         */
+        class CrashWriter {
+        private:
+            std::unique_ptr<char[]> buffer;
+            std::size_t capacity = 0;
+            std::size_t size = 0;
+            int fd = -1;
+            bool toStderr = false;
+
+            template <typename T>
+            static T read(const unsigned char *&p) noexcept {
+                T value;
+                std::memcpy(&value, p, sizeof(T));
+                p += sizeof(T);
+                return value;
+            }
+
+            // Render the next tagged argument, false once the arguments are used up
+            bool appendArg(const unsigned char *&p, const unsigned char *end) noexcept {
+                if (p >= end) {
+                    return false;
+                }
+                switch (static_cast<ArgTag>(*p++)) {
+                    case ArgTag::Bool:
+                        append(read<bool>(p) ? "true" : "false");
+                        break;
+                    case ArgTag::Char: {
+                        char c = read<char>(p);
+                        append(std::string_view(&c, 1));
+                        break;
+                    }
+                    case ArgTag::Int:
+                        appendNumber(read<neko::int64>(p));
+                        break;
+                    case ArgTag::UInt:
+                        appendNumber(read<neko::uint64>(p));
+                        break;
+                    case ArgTag::Float:
+                        appendNumber(read<float>(p));
+                        break;
+                    case ArgTag::Double:
+                        appendNumber(read<double>(p));
+                        break;
+                    case ArgTag::Pointer:
+                        append("0x");
+                        appendNumber(reinterpret_cast<std::uintptr_t>(read<const void *>(p)), 16);
+                        break;
+                    case ArgTag::String: {
+                        auto length = read<neko::uint32>(p);
+                        append(std::string_view(reinterpret_cast<const char *>(p), length));
+                        p += length;
+                        break;
+                    }
+                    default:
+                        p = end;
+                        return false;
+                }
+                return true;
+            }
+
+            void appendTimestamp(std::chrono::system_clock::time_point tp) noexcept {
+                using namespace std::chrono;
+                auto ms = floor<milliseconds>(tp);
+                auto day = floor<days>(ms);
+                year_month_day ymd(day);
+                hh_mm_ss hms(ms - day);
+                char text[23];
+                writeDigits(text, static_cast<unsigned>(static_cast<int>(ymd.year())), 4);
+                text[4] = '-';
+                writeDigits(text + 5, static_cast<unsigned>(ymd.month()), 2);
+                text[7] = '-';
+                writeDigits(text + 8, static_cast<unsigned>(ymd.day()), 2);
+                text[10] = ' ';
+                writeDigits(text + 11, static_cast<unsigned>(hms.hours().count()), 2);
+                text[13] = ':';
+                writeDigits(text + 14, static_cast<unsigned>(hms.minutes().count()), 2);
+                text[16] = ':';
+                writeDigits(text + 17, static_cast<unsigned>(hms.seconds().count()), 2);
+                text[19] = '.';
+                writeDigits(text + 20, static_cast<unsigned>(hms.subseconds().count()), 3);
+                append(std::string_view(text, sizeof(text)));
+            }
+
+            void appendDeferred(std::string_view fmt, std::span<const unsigned char> args) noexcept {
+                const unsigned char *p = args.data();
+                const unsigned char *end = p + args.size();
+                for (std::size_t i = 0; i < fmt.size(); ++i) {
+                    const char c = fmt[i];
+                    if ((c == '{' || c == '}') && i + 1 < fmt.size() && fmt[i + 1] == c) {
+                        append(std::string_view(&c, 1));
+                        ++i;
+                    } else if (c == '{') {
+                        const std::size_t close = fmt.find('}', i);
+                        if (close == std::string_view::npos || !appendArg(p, end)) {
+                            append(fmt.substr(i, close == std::string_view::npos ? fmt.size() - i : close - i + 1));
+                        }
+                        if (close == std::string_view::npos) {
+                            return;
+                        }
+                        i = close;
+                    } else {
+                        append(std::string_view(&c, 1));
+                    }
+                }
+            }
+
+        public:
+            CrashWriter() = default;
+
+            /**
+             * @param fd Descriptor to write to, -1 for none; owned by the writer
+             * @param toStderr Also write to standard error
+             * @param capacity Size of the preallocated buffer
+             */
+            CrashWriter(int fd, bool toStderr, std::size_t capacity)
+                : buffer(std::make_unique<char[]>(std::max<std::size_t>(capacity, 256))),
+                  capacity(std::max<std::size_t>(capacity, 256)), fd(fd), toStderr(toStderr) {}
+
+            CrashWriter(const CrashWriter &) = delete;
+            CrashWriter &operator=(const CrashWriter &) = delete;
+
+            CrashWriter &operator=(CrashWriter &&other) noexcept {
+                close();
+                buffer = std::move(other.buffer);
+                capacity = std::exchange(other.capacity, 0);
+                size = std::exchange(other.size, 0);
+                fd = std::exchange(other.fd, -1);
+                toStderr = other.toStderr;
+                return *this;
+            }
+
+            ~CrashWriter() {
+                close();
+            }
+
+            void append(std::string_view text) noexcept {
+                while (!text.empty() && capacity > 0) {
+                    if (size == capacity) {
+                        flush();
+                    }
+                    const std::size_t n = std::min(text.size(), capacity - size);
+                    std::memcpy(buffer.get() + size, text.data(), n);
+                    size += n;
+                    text.remove_prefix(n);
+                }
+            }
+
+            template <typename T>
+            void appendNumber(T value, int base = 10) noexcept {
+                char digits[32];
+                std::to_chars_result result;
+                if constexpr (std::floating_point<T>) {
+                    result = std::to_chars(digits, digits + sizeof(digits), value);
+                } else {
+                    result = std::to_chars(digits, digits + sizeof(digits), value, base);
+                }
+                append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+            }
+
+            /**
+             * @brief Append one record as "[time] [level] [thread] [file:line] message key=value"
+             */
+            void appendRecord(const AsyncRecord &slot) noexcept {
+                const LogRecord &record = slot.record;
+                append("[");
+                appendTimestamp(record.timestamp);
+                append("] [");
+                append(levelToString(record.level));
+                append("] [");
+                append(record.threadName);
+                append("] [");
+                append(record.location.getFile());
+                append(":");
+                appendNumber(record.location.getLine());
+                append("] ");
+                if (slot.deferred.empty()) {
+                    append(record.message);
+                } else {
+                    appendDeferred(slot.deferred.getFormat(), slot.deferred.getArgs());
+                }
+                for (const auto &field : record.fields) {
+                    append(" ");
+                    append(field.key);
+                    append("=");
+                    if (const auto *b = std::get_if<bool>(&field.value)) {
+                        append(*b ? "true" : "false");
+                    } else if (const auto *s = std::get_if<std::string>(&field.value)) {
+                        append(*s);
+                    } else if (const auto *i = std::get_if<neko::int64>(&field.value)) {
+                        appendNumber(*i);
+                    } else if (const auto *u = std::get_if<neko::uint64>(&field.value)) {
+                        appendNumber(*u);
+                    } else if (const auto *d = std::get_if<double>(&field.value)) {
+                        appendNumber(*d);
+                    }
+                }
+                append("\n");
+            }
+
+            /**
+             * @brief Write the buffered bytes to every target
+             */
+            void flush() noexcept {
+                if (size == 0) {
+                    return;
+                }
+                if (fd >= 0) {
+                    writeAll(fd, buffer.get(), size);
+                }
+                if (toStderr) {
+                    writeAll(2, buffer.get(), size);
+                }
+                size = 0;
+            }
+
+            void close() noexcept {
+#if NEKO_LOG_HAS_CRASH_HANDLER
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+#endif
+                fd = -1;
+            }
+        };
+
+    } // namespace detail
+
+    /**
+     * @brief Main Logger class
+     */
+    class Logger {
+    private:
+        std::atomic<Level> level = Level::Info;
+        std::atomic<neko::SyncMode> mode = neko::SyncMode::Sync;
+        /**
+         * @brief An appender and the lock taken around it unless it is thread-safe
+         */
+        struct AppenderSlot {
+            std::unique_ptr<IAppender> appender;
+            bool serialized;
+            std::mutex mutex;
+
+            explicit AppenderSlot(std::unique_ptr<IAppender> appender)
+                : appender(std::move(appender)), serialized(!this->appender->isThreadSafe()) {}
+
+            template <typename Call>
+            void call(Call &&call) {
+                if (serialized) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    call(*appender);
+                } else {
+                    call(*appender);
+                }
+            }
+        };
+
+        // Immutable appender snapshot, replaced copy-on-write so the log path reads it without locking
+        using AppenderList = std::vector<std::shared_ptr<AppenderSlot>>;
+#if defined(__cpp_lib_atomic_shared_ptr)
+        std::atomic<std::shared_ptr<const AppenderList>> appenders = std::make_shared<const AppenderList>();
+#else
+        std::shared_ptr<const AppenderList> appenders = std::make_shared<const AppenderList>();
+#endif
+        // Serializes writers of the appender snapshot only
+        mutable std::mutex appenderMutex;
+
+        std::shared_ptr<const AppenderList> loadAppenders() const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+            return appenders.load(std::memory_order_acquire);
+#else
+            return std::atomic_load_explicit(&appenders, std::memory_order_acquire);
+#endif
+        }
+
+        void publishAppenders(std::shared_ptr<const AppenderList> list) {
+#if defined(__cpp_lib_atomic_shared_ptr)
+            appenders.store(std::move(list), std::memory_order_release);
+#else
+            std::atomic_store_explicit(&appenders, std::move(list), std::memory_order_release);
+#endif
+        }
+
+        // Bounded ring buffer for async logging, created on first switch to async mode
+        std::unique_ptr<detail::BoundedQueue<detail::AsyncRecord>> logQueue;
+        std::size_t queueCapacity = 8192;
+
+        std::atomic<OverflowPolicy> overflowPolicy = OverflowPolicy::Block;
+        std::atomic<Level> overflowLevel = Level::Warn;
+        std::atomic<std::uint64_t> droppedCount = 0;    // Total since creation
+        std::atomic<std::uint64_t> unreportedDrops = 0; // Not yet reported by a synthetic record
+
+        // Backend owned by startAsync / stopAsync
+        std::size_t maxBatchSize = 256;
+        std::size_t longestMessage = 0; // Consumer side only, see takeBatch
+        std::thread backendThread;
+        std::mutex backendMutex;
+
+        // Guards creation of the ring buffer; the consumer sleeps through parking
+        mutable std::mutex logQueueMutex;
+        detail::ConsumerParking parking;
+        // Producers between their mode check and their push, waited for before a final drain
+        std::atomic<std::size_t> producers = 0;
+        // Running log loops; the ring buffer is only replaced while there are none
+        std::atomic<std::size_t> activeLoops = 0;
+
+        // Process-wide fatal signal handling, see installCrashHandler
+        struct CrashState {
+            std::mutex mutex; // Serializes install and remove
+            std::atomic<Logger *> logger = nullptr;
+            std::atomic<bool> handling = false;
+            detail::CrashWriter writer;
+#if NEKO_LOG_HAS_CRASH_HANDLER
+            static constexpr std::array<int, 5> signals = {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL};
+            std::array<struct sigaction, signals.size()> previous{};
+#endif
+        };
+
+        // Leaked so the handler stays usable while static objects are destroyed
+        static CrashState &crashState() {
+            static CrashState *state = new CrashState();
+            return *state;
+        }
+
+#if NEKO_LOG_HAS_CRASH_HANDLER
+        /**
+         * @brief Take the writer away from the signal handler before replacing it
+         * @note Handlers claim the writer through the same flag, so a handler that has started keeps it, and this returns
+         *       false. Otherwise the handler is detached and the caller must clear the flag after replacing the writer;
+         *       a signal in between skips writing and only chains to the previous handler. The caller holds state.mutex.
+         */
+        static bool claimCrashWriter(CrashState &state) noexcept {
+            if (state.handling.exchange(true, std::memory_order_acq_rel)) {
+                return false;
+            }
+            state.logger.store(nullptr, std::memory_order_release);
+            return true;
+        }
+
+        static void onFatalSignal(int signal) {
+            CrashState &state = crashState();
+            if (!state.handling.exchange(true, std::memory_order_acq_rel)) {
+                if (Logger *owner = state.logger.load(std::memory_order_acquire)) {
+                    owner->writePendingOnCrash(signal, state.writer);
+                }
+            }
+            // Hand the signal to whatever was installed before and deliver it again once this handler returns
+            for (std::size_t i = 0; i < CrashState::signals.size(); ++i) {
+                if (CrashState::signals[i] == signal) {
+                    ::sigaction(signal, &state.previous[i], nullptr);
+                }
+            }
+            ::raise(signal);
+        }
+#endif
+
+        /**
+         * @brief Write the records still queued for the backend through the crash writer
+         * @note Runs inside the signal handler, so it only uses the lock-free queue and the preallocated writer.
+         */
+        void writePendingOnCrash(int signal, detail::CrashWriter &writer) noexcept {
+            writer.append("=== Fatal signal ");
+            writer.appendNumber(signal);
+            writer.append(", writing pending log records ===\n");
+            if (auto *queue = logQueue.get()) {
+                while (queue->tryConsume([&writer](const detail::AsyncRecord &slot) { writer.appendRecord(slot); })) {
+                }
+            }
+            writer.flush();
+        }
+
+        /**
+         * @brief Deliver an already level-checked message to the appenders or the async queue
+         * @note Neither path allocates once the reused records have grown to the usual message size.
+         */
+        void submit(Level level, std::string_view message, const neko::SrcLocInfo &location, std::span<const Field> fields = {}) {
+            if (mode.load(std::memory_order_relaxed) == neko::SyncMode::Async &&
+                enqueue(level, location, [message, fields](detail::AsyncRecord &slot) {
+                    slot.record.message.assign(message);
+                    slot.record.fields.assign(fields.begin(), fields.end());
+                })) {
+                return;
+            }
+
+            detail::ScratchRecord record;
+            record->stamp(level, location);
+            record->message.assign(message);
+            record->fields.assign(fields.begin(), fields.end());
+            append(*record);
+        }
+
+        /**
+         * @brief Stamp a free ring buffer slot in place and let fill set the message or deferred arguments
+         * @note The slot still holds the buffers of the record that used it last, so the ring doubles as a record pool.
+         * @return false if async mode ended before the push, the caller then writes the record itself
+         */
+        template <typename Fill>
+        bool enqueue(Level level, const neko::SrcLocInfo &location, Fill &&fill) {
+            // Announced before the mode is checked, so a drain that follows the switch to sync mode waits for this push
+            struct Announce {
+                std::atomic<std::size_t> &count;
+                explicit Announce(std::atomic<std::size_t> &count) : count(count) {
+                    count.fetch_add(1);
+                }
+                ~Announce() {
+                    count.fetch_sub(1, std::memory_order_release);
+                }
+            } announce(producers);
+            if (mode.load() != neko::SyncMode::Async) {
+                return false;
+            }
+
+            auto tryPush = [&] {
+                return logQueue->tryEmplace([&](detail::AsyncRecord &slot) {
+                    slot.record.stamp(level, location);
+                    slot.deferred.reset();
+                    fill(slot);
+                });
+            };
+            if (detail::pushWithPolicy(*logQueue, tryPush, level,
+                                       overflowPolicy.load(std::memory_order_relaxed),
+                                       overflowLevel.load(std::memory_order_relaxed),
+                                       [this] { recordDrop(); })) {
+                parking.wake();
+            }
+            return true;
+        }
+
+        /**
+         * @brief Copy up to maxBatchSize queued records into the batch, formatting deferred messages
+         * @note Records are copy-assigned so both the slots and the batch keep their capacity. An entry that has to grow
+         *       is grown to the longest message seen so far, so each entry allocates once rather than once per longer message.
+         * @return Number of records written to the front of the batch
+         */
+        std::size_t takeBatch(std::vector<LogRecord> &batch) {
+            std::size_t count = 0;
+            while (count < maxBatchSize && logQueue->tryConsume([this, &batch, count](detail::AsyncRecord &slot) {
+                       slot.materialize();
+                       if (count == batch.size()) {
+                           batch.emplace_back();
+                       }
+                       LogRecord &entry = batch[count];
+                       longestMessage = std::max(longestMessage, slot.record.message.size());
+                       if (entry.message.capacity() < slot.record.message.size()) {
+                           entry.message.reserve(longestMessage);
+                       }
+                       entry = slot.record;
+                   })) {
+                ++count;
+            }
+            return count;
+        }
+
+        /**
+         * @brief Write a batch of records, loading the appender snapshot once
+         * @note Each appender receives its runs of enabled records through appendBatch.
+         */
+        void dispatch(std::span<const LogRecord> records) {
+            auto snapshot = loadAppenders();
+            const Level loggerLevel = level.load(std::memory_order_relaxed);
+            for (const auto &slot : *snapshot) {
+                const IAppender &appender = *slot->appender;
+                std::size_t begin = 0;
+                while (begin < records.size()) {
+                    while (begin < records.size() && !appender.isEnabled(records[begin].level, loggerLevel)) {
+                        ++begin;
+                    }
+                    std::size_t end = begin;
+                    while (end < records.size() && appender.isEnabled(records[end].level, loggerLevel)) {
+                        ++end;
+                    }
+                    if (end > begin) {
+                        slot->call([run = records.subspan(begin, end - begin)](IAppender &target) { target.appendBatch(run); });
+                    }
+                    begin = end;
+                }
+            }
+        }
+
+        /**
+         * @brief Write everything left in the queue, then flush
+         * @note Called after the switch to sync mode. Keeps draining until producers that saw async mode
+         *       before the switch have pushed, so blocked producers can finish.
+         */
+        void drainQueue() {
+            std::vector<LogRecord> batch;
+            for (;;) {
+                while (std::size_t count = takeBatch(batch)) {
+                    dispatch(std::span<const LogRecord>(batch.data(), count));
+                }
+                if (producers.load() == 0 && logQueue->empty()) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+            reportDrops();
+            flush();
+        }
+
+        /**
+         * @brief Replace the ring buffer, writing whatever an earlier async run left in it
+         * @note Caller must hold backendMutex.
+         */
+        bool resizeQueue(std::size_t capacity) {
+            std::lock_guard<std::mutex> lock(logQueueMutex);
+            if (mode.load() == neko::SyncMode::Async || activeLoops.load() != 0) {
+                return false;
+            }
+            queueCapacity = capacity;
+            if (logQueue) {
+                drainQueue();
+                logQueue.reset();
+            }
+            return true;
+        }
+
+        void recordDrop() {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            unreportedDrops.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Emit a record summarising the drops since the last report
+         * @note Called by the consumer once the queue has drained, so the summary follows the records that made it.
+         */
+        void reportDrops() {
+            if (unreportedDrops.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+            const std::uint64_t dropped = unreportedDrops.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) {
+                append(LogRecord(Level::Warn, std::format("{} log records dropped, the async queue was full", dropped)));
+            }
+        }
+
+        /**
+         * @return false if the timeout passed without records or a stop request
+         */
+        bool waitForRecords(std::chrono::milliseconds timeout = std::chrono::milliseconds(500)) {
+            return parking.wait([this] {
+                return !logQueue->empty() || mode.load() != neko::SyncMode::Async;
+            }, timeout);
+        }
+
+        /**
+         * @brief Let every appender write what it buffered once the backend has gone idle
+         */
+        void flushIdle() {
+            auto snapshot = loadAppenders();
+            for (const auto &slot : *snapshot) {
+                slot->call([](IAppender &appender) { appender.flushIdle(); });
+            }
+        }
+
+    public:
+        explicit Logger(Level level = Level::Info) : level(level) {
+            addAppender(std::make_unique<ConsoleAppender>());
+        }
+
+        explicit Logger(Level level, const std::string &filename) : level(level) {
+            addAppender(std::make_unique<FileAppender>(filename));
+        }
+
+        ~Logger() {
+            removeCrashHandler();
+            stopAsync();
+        }
+
+        // === Info ===
+
+        Level getLevel() const {
+            return level.load(std::memory_order_relaxed);
+        }
+        neko::SyncMode getMode() const {
+            return mode.load();
+        }
+
+        std::size_t getQueueCapacity() const {
+            std::lock_guard<std::mutex> lock(logQueueMutex);
+            return logQueue ? logQueue->capacity() : queueCapacity;
+        }
+
+        /**
+         * @brief Check whether a record of the given level would be logged
+         * @note A single relaxed atomic load, called before any message is built.
+         */
+        bool isEnabled(Level level) const {
+            Level current = this->level.load(std::memory_order_relaxed);
+            return level >= current && current != Level::Off;
+        }
+
+        // === Control ===
+
+        void setLevel(Level level) {
+            this->level.store(level, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Set the logging mode
+         * @note Switching to async mode allocates the ring buffer on first use.
+         */
+        void setMode(neko::SyncMode m) {
+            if (m == neko::SyncMode::Async) {
+                std::lock_guard<std::mutex> lock(logQueueMutex);
+                if (!logQueue) {
+                    logQueue = std::make_unique<detail::BoundedQueue<detail::AsyncRecord>>(queueCapacity);
+                }
+            }
+            mode.store(m);
+        }
+
+        /**
+         * @brief Set what happens when the async queue is full
+         * @param policy Overflow policy
+         * @param level Records at or above this level are kept under OverflowPolicy::DropBelowLevel
+         * @note Dropped records are counted, and a Warn record with the count is logged once the queue has drained.
+         */
+        void setOverflowPolicy(OverflowPolicy policy, Level level = Level::Warn) {
+            overflowLevel.store(level, std::memory_order_relaxed);
+            overflowPolicy.store(policy, std::memory_order_relaxed);
+        }
+
+        OverflowPolicy getOverflowPolicy() const {
+            return overflowPolicy.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Number of records dropped because the async queue was full
+         */
+        std::uint64_t getDroppedCount() const {
+            return droppedCount.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Set the number of slots of the async ring buffer (rounded up to a power of two)
+         * @return false, leaving the queue as it is, while async mode is on or a log loop is running
+         * @note Records still queued from an earlier async run are written first. The new queue is created on the next switch to async mode.
+         */
+        bool setQueueCapacity(std::size_t capacity) {
+            std::lock_guard<std::mutex> lock(backendMutex);
+            return resizeQueue(capacity);
+        }
+
+        void addFileAppender(const std::string &filename, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
+            addAppender(std::make_unique<FileAppender>(filename, isTruncate, std::move(formatter)));
+        }
+
+        void addFileAppender(const std::string &filename, Level level, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
+            addAppender(std::make_unique<FileAppender>(filename, level, isTruncate, std::move(formatter)));
+        }
+
+        void addConsoleAppender(std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
+            addAppender(std::make_unique<ConsoleAppender>(std::move(formatter)));
+        }
+
+        void addConsoleAppender(Level level, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
+            addAppender(std::make_unique<ConsoleAppender>(level, std::move(formatter)));
+        }
+
+        /**
+         * @brief Add an appender
+         * @note Publishes a new appender snapshot; records being logged concurrently use the previous one.
+         */
+        void addAppender(std::unique_ptr<IAppender> appender) {
+            std::lock_guard<std::mutex> lock(appenderMutex);
+            auto list = std::make_shared<AppenderList>(*loadAppenders());
+            list->push_back(std::make_shared<AppenderSlot>(std::move(appender)));
+            publishAppenders(std::move(list));
+        }
+
+        /**
+         * @brief Remove all appenders
+         * @note Appenders are destroyed once the last in-flight record using them has been written.
+         */
+        void clearAppenders() {
+            std::lock_guard<std::mutex> lock(appenderMutex);
+            publishAppenders(std::make_shared<const AppenderList>());
+        }
+
+        void append(const LogRecord &record) {
+            auto snapshot = loadAppenders();
+            for (const auto &slot : *snapshot) {
+                if (slot->appender->isEnabled(record.level, level.load(std::memory_order_relaxed))) {
+                    slot->call([&record](IAppender &appender) { appender.append(record); });
+                }
+            }
+        }
+
+        void flush() {
+            auto snapshot = loadAppenders();
+            for (const auto &slot : *snapshot) {
+                slot->call([](IAppender &appender) { appender.flush(); });
+            }
+        }
+
+        /**
+         * @brief Run the logging loop for async mode
+         * @note This will block until the mode is set to Sync or the application exits.
+         *       Prefer startAsync, which runs this loop on a thread owned by the logger.
+         */
+        void runLoop() {
+            if (!logQueue) {
+                return;
+            }
+            activeLoops.fetch_add(1);
+            struct Leave {
+                std::atomic<std::size_t> &count;
+                ~Leave() {
+                    count.fetch_sub(1);
+                }
+            } leave{activeLoops};
+
+            std::vector<LogRecord> batch;
+            detail::prepareBatch(batch, maxBatchSize);
+            bool unflushed = false;
+            while (mode.load() == neko::SyncMode::Async) {
+                if (std::size_t count = takeBatch(batch)) {
+                    dispatch(std::span<const LogRecord>(batch.data(), count));
+                    unflushed = true;
+                    continue;
+                }
+                reportDrops();
+                if (!unflushed) {
+                    waitForRecords();
+                } else if (!waitForRecords(detail::idleFlushDelay)) {
+                    // Idle: write out appender buffers instead of waiting for the next record
+                    flushIdle();
+                    unflushed = false;
+                }
+            }
+
+            // Flush remaining logs when stopping the loop
+            drainQueue();
+        }
+
+        /**
+         * @brief Stop the logging loop
+         * @note This will stop the async logging loop and flush any remaining logs.
+         */
+        void stopLoop() {
+            if (mode.load() != neko::SyncMode::Async) {
+                return;
+            }
+            parking.notify([this] { mode.store(neko::SyncMode::Sync); });
+        }
+
+        /**
+         * @brief Switch to async mode with a backend thread owned by the logger
+         * @return false if the backend is already running or a log loop started with runLoop is still active
+         * @note The backend takes queued records in batches and writes each batch with a single appender snapshot.
+         *       Records still queued from setMode(SyncMode::Async) without a consumer are written before the queue is replaced.
+         */
+        bool startAsync(const AsyncOptions &options = {}) {
+            std::lock_guard<std::mutex> lock(backendMutex);
+            if (backendThread.joinable()) {
+                return false;
+            }
+
+            // A log loop run by the application already consumes the queue
+            if (activeLoops.load() != 0) {
+                return false;
+            }
+            // Async mode switched on without a consumer: leave it, so the queued records are written before the queue is replaced
+            if (mode.load() == neko::SyncMode::Async) {
+                stopLoop();
+            }
+            // No consumer is running, so the drain below already takes the new batch size
+            maxBatchSize = std::max<std::size_t>(options.maxBatchSize, 1);
+            if (!resizeQueue(options.queueCapacity)) {
+                return false;
+            }
+            setOverflowPolicy(options.overflowPolicy, options.overflowLevel);
+            setMode(neko::SyncMode::Async);
+
+            backendThread = std::thread([this, name = options.threadName] {
+                if (!name.empty()) {
+                    threadNameManager.setCurrentThreadName(name);
+                }
+                runLoop();
+            });
+            return true;
+        }
+
+        /**
+         * @brief Stop the backend started by startAsync and switch back to sync mode
+         * @note Returns once every record logged before the call has been written and the appenders flushed.
+         */
+        void stopAsync() {
+            std::lock_guard<std::mutex> lock(backendMutex);
+            if (!backendThread.joinable()) {
+                return;
+            }
+            stopLoop();
+            backendThread.join();
+
+            // Records pushed by producers that raced with the switch to sync mode
+            drainQueue();
+        }
+
+        /**
+         * @brief Write the records still in the async queue when the process dies from a fatal signal
+         * @param filename File the records are appended to; opened now so the handler only needs write(2). Empty for none
+         * @param toStderr Also write the records to standard error
+         * @param bufferSize Size of the buffer allocated up front for formatting them
+         * @return false if crash handling is unavailable, another logger owns the handler or a fatal signal is being handled
+         * @note Handles SIGSEGV, SIGABRT, SIGBUS, SIGFPE and SIGILL, then restores the previous handler and raises the signal again.
+         *       The handler runs on an alternate signal stack, which is set up here for the calling thread; call
+         *       log::installCrashStack() on other threads whose stack overflows should be handled too.
+         *       Records the backend has already taken and bytes buffered inside appenders are not recovered, so use
+         *       FlushPolicy::immediate() on appenders whose tail matters. Only one logger per process can own the handler.
+         */
+        bool installCrashHandler([[maybe_unused]] const std::string &filename = "", [[maybe_unused]] bool toStderr = true,
+                                 [[maybe_unused]] std::size_t bufferSize = 64 * 1024) {
+#if NEKO_LOG_HAS_CRASH_HANDLER
+            CrashState &state = crashState();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            Logger *owner = state.logger.load();
+            if (owner != nullptr && owner != this) {
+                return false;
+            }
+
+            int fd = -1;
+            if (!filename.empty()) {
+                fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+                if (fd < 0) {
+                    throw neko::ex::FileError("Failed to open crash log file: " + filename);
+                }
+            }
+
+            detail::CrashWriter writer(fd, toStderr, bufferSize);
+            // Keep the handlers found by the first install, a reinstall only replaces the writer
+            if (!claimCrashWriter(state)) {
+                return false;
+            }
+            state.writer = std::move(writer);
+            state.logger.store(this, std::memory_order_release);
+            state.handling.store(false, std::memory_order_release);
+
+            detail::installAltStack();
+            if (owner == nullptr) {
+                struct sigaction action {};
+                action.sa_handler = &Logger::onFatalSignal;
+                sigemptyset(&action.sa_mask);
+                action.sa_flags = SA_ONSTACK;
+                for (std::size_t i = 0; i < CrashState::signals.size(); ++i) {
+                    ::sigaction(CrashState::signals[i], &action, &state.previous[i]);
+                }
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Restore the signal handlers replaced by installCrashHandler and close its file
+         */
+        void removeCrashHandler() {
+#if NEKO_LOG_HAS_CRASH_HANDLER
+            CrashState &state = crashState();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.logger.load() != this) {
+                return;
+            }
+            for (std::size_t i = 0; i < CrashState::signals.size(); ++i) {
+                ::sigaction(CrashState::signals[i], &state.previous[i], nullptr);
+            }
+            // A handler still running on another thread keeps its writer, the process is going down anyway
+            if (claimCrashWriter(state)) {
+                state.writer = detail::CrashWriter();
+                state.handling.store(false, std::memory_order_release);
+            } else {
+                state.logger.store(nullptr, std::memory_order_release);
+            }
+#endif
+        }
+
+        // === Logging ===
+
+        void log(Level level, std::string_view message, const neko::SrcLocInfo &location = {}) {
+            if (!isEnabled(level)) {
+                return;
+            }
+            submit(level, message, location);
+        }
+
+        /**
+         * @brief Log a message with structured fields, see kv()
+         */
+        void log(Level level, std::string_view message, const neko::SrcLocInfo &location, std::span<const Field> fields) {
+            if (!isEnabled(level)) {
+                return;
             }
-            preOutput(filename, isTruncate);
+            submit(level, message, location, fields);
         }
 
-        explicit FileAppender(const std::string &filename, Level level, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>())
-            : formatter(std::move(formatter)), file(filename, isTruncate ? std::ios::trunc : std::ios::app) {
-            if (!file.is_open()) {
-                throw neko::ex::FileError("Failed to open log file: " + filename);
+        /**
+         * @brief Log a lazily produced message
+         * @note The producer is only invoked when the level is enabled.
+         */
+        template <MessageProducer F>
+        void log(Level level, F &&producer, const neko::SrcLocInfo &location = {}) {
+            if (!isEnabled(level)) {
+                return;
+            }
+            auto &&message = producer();
+            if constexpr (std::convertible_to<decltype(message), std::string_view>) {
+                submit(level, message, location);
+            } else {
+                submit(level, std::string(message), location);
             }
-            setLevel(level);
-            preOutput(filename, isTruncate);
         }
 
-        void preOutput(const std::string &filename, bool isTruncate) {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (file.is_open()) {
-                file << "=== FileAppender initialized ===" << std::endl;
-                file << "=== FileName: " << filename << ", Level: " << levelToString(getLevel()) << ", Mode: " << (isTruncate ? "Truncate" : "Append") << " ===" << std::endl;
-                file << "=== Log Start ===" << std::endl;
+        /**
+         * @brief Log a formatted message
+         * @note In async mode, when every argument is trivially copyable (arithmetic, pointer or string),
+         *       the arguments are captured into the record and std::format runs on the log loop thread.
+         */
+        template <typename... Args>
+        void logFormatted(Level level, std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
+            logFormatted(level, std::span<const Field>{}, fmt, location, std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Log a formatted message with structured fields
+         */
+        template <typename... Args>
+        void logFormatted(Level level, std::span<const Field> fields, std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
+            // Checked before any argument is formatted, so disabled calls cost one load and one branch
+            if (!isEnabled(level)) {
+                return;
+            }
+            const bool async = mode.load(std::memory_order_relaxed) == neko::SyncMode::Async;
+            if constexpr (detail::DeferrableArgs<Args...>) {
+                if (async) {
+                    detail::DeferredFormat deferred;
+                    if (deferred.capture(fmt.get(), args...) &&
+                        enqueue(level, location, [&deferred, fields](detail::AsyncRecord &slot) {
+                            slot.deferred = deferred;
+                            slot.record.fields.assign(fields.begin(), fields.end());
+                        })) {
+                        return;
+                    }
+                }
             }
+
+            // Format into the thread's reused record instead of a fresh string
+            detail::ScratchRecord record;
+            record->message.clear();
+            std::format_to(std::back_inserter(record->message), fmt, std::forward<Args>(args)...);
+            if (async && enqueue(level, location, [&record, fields](detail::AsyncRecord &slot) {
+                    slot.record.message.assign(record->message);
+                    slot.record.fields.assign(fields.begin(), fields.end());
+                })) {
+                return;
+            }
+            record->stamp(level, location);
+            record->fields.assign(fields.begin(), fields.end());
+            append(*record);
         }
 
-        void append(const LogRecord &record) override {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (file.is_open()) {
-                file << formatter->format(record) << std::endl;
+        // === compile-time level logging ===
+
+        /**
+         * @brief Log at a level known at compile time
+         * @note Compiles to nothing when Lv is below NEKO_LOG_ACTIVE_LEVEL.
+         *       Use the MessageProducer overload to also guarantee that no argument is evaluated.
+         */
+        template <Level Lv>
+        void logAt(std::string_view message, const neko::SrcLocInfo &location = {}) {
+            if constexpr (isActive(Lv)) {
+                log(Lv, message, location);
             }
         }
 
-        void flush() override {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (file.is_open()) {
-                file.flush();
+        template <Level Lv, MessageProducer F>
+        void logAt(F &&producer, const neko::SrcLocInfo &location = {}) {
+            if constexpr (isActive(Lv)) {
+                log(Lv, std::forward<F>(producer), location);
             }
         }
 
-        ~FileAppender() {
-            if (file.is_open()) {
-                file.close();
+        template <Level Lv, typename... Args>
+            requires(sizeof...(Args) > 0 && detail::FormatArgs<Args...>)
+        void logAt(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
+            if constexpr (isActive(Lv)) {
+                logFormatted(Lv, fmt, location, std::forward<Args>(args)...);
             }
         }
-    };
 
-    /**
-     * @brief Main Logger class
-     */
-    class Logger {
-    private:
-        Level level = Level::Info;
-        neko::SyncMode mode = neko::SyncMode::Sync;
-        std::vector<std::unique_ptr<IAppender>> appenders;
-        mutable std::mutex appenderMutex;
+        template <Level Lv, typename... Fields>
+            requires detail::FieldArgs<Fields...>
+        void logAt(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+            if constexpr (isActive(Lv)) {
+                if (!isEnabled(Lv)) {
+                    return;
+                }
+                const std::array<Field, sizeof...(Fields)> list{std::forward<Fields>(fields)...};
+                submit(Lv, message, location, list);
+            }
+        }
 
-        // Queue for async logging
-        std::queue<LogRecord> logQueue;
-        std::condition_variable logQueueCondVar;
-        mutable std::mutex logQueueMutex;
+        // === single message logging ===
 
-    public:
-        explicit Logger(Level level = Level::Info) : level(level) {
-            addAppender(std::make_unique<ConsoleAppender>());
+        void debug(std::string_view message, const neko::SrcLocInfo &location = {}) {
+            logAt<Level::Debug>(message, location);
         }
 
-        explicit Logger(Level level, const std::string &filename) : level(level) {
-            addAppender(std::make_unique<FileAppender>(filename));
+        void info(std::string_view message, const neko::SrcLocInfo &location = {}) {
+            logAt<Level::Info>(message, location);
         }
 
-        // === Info ===
-
-        Level getLevel() const {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            return level;
+        void warn(std::string_view message, const neko::SrcLocInfo &location = {}) {
+            logAt<Level::Warn>(message, location);
         }
-        neko::SyncMode getMode() const {
-            return mode;
+
+        void error(std::string_view message, const neko::SrcLocInfo &location = {}) {
+            logAt<Level::Error>(message, location);
         }
 
-        bool isEnabled(Level level) const {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            return level >= this->level && this->level != Level::Off;
+        // === lazily evaluated message logging ===
+
+        template <MessageProducer F>
+        void debug(F &&producer, const neko::SrcLocInfo &location = {}) {
+            logAt<Level::Debug>(std::forward<F>(producer), location);
         }
 
-        // === Control ===
+        template <MessageProducer F>
+        void info(F &&producer, const neko::SrcLocInfo &location = {}) {
+            logAt<Level::Info>(std::forward<F>(producer), location);
+        }
 
-        void setLevel(Level level) {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            this->level = level;
+        template <MessageProducer F>
+        void warn(F &&producer, const neko::SrcLocInfo &location = {}) {
+            logAt<Level::Warn>(std::forward<F>(producer), location);
         }
 
-        void setMode(neko::SyncMode m) {
-            this->mode = m;
+        template <MessageProducer F>
+        void error(F &&producer, const neko::SrcLocInfo &location = {}) {
+            logAt<Level::Error>(std::forward<F>(producer), location);
         }
 
-        void addFileAppender(const std::string &filename, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            appenders.push_back(std::make_unique<FileAppender>(filename, isTruncate, std::move(formatter)));
+        // === formatted message logging ===
+
+        template <typename... Args>
+            requires detail::FormatArgs<Args...>
+        void debug(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
+            if constexpr (isActive(Level::Debug)) {
+                logFormatted(Level::Debug, fmt, location, std::forward<Args>(args)...);
+            }
         }
 
-        void addFileAppender(const std::string &filename, Level level, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            appenders.push_back(std::make_unique<FileAppender>(filename, level, isTruncate, std::move(formatter)));
+        template <typename... Args>
+            requires detail::FormatArgs<Args...>
+        void info(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
+            if constexpr (isActive(Level::Info)) {
+                logFormatted(Level::Info, fmt, location, std::forward<Args>(args)...);
+            }
         }
 
-        void addConsoleAppender(std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            appenders.push_back(std::make_unique<ConsoleAppender>(std::move(formatter)));
+        template <typename... Args>
+            requires detail::FormatArgs<Args...>
+        void warn(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
+            if constexpr (isActive(Level::Warn)) {
+                logFormatted(Level::Warn, fmt, location, std::forward<Args>(args)...);
+            }
         }
 
-        void addConsoleAppender(Level level, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            appenders.push_back(std::make_unique<ConsoleAppender>(level, std::move(formatter)));
+        template <typename... Args>
+            requires detail::FormatArgs<Args...>
+        void error(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
+            if constexpr (isActive(Level::Error)) {
+                logFormatted(Level::Error, fmt, location, std::forward<Args>(args)...);
+            }
         }
 
-        void addAppender(std::unique_ptr<IAppender> appender) {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            appenders.push_back(std::move(appender));
+        // === structured logging ===
+
+        template <typename... Fields>
+            requires detail::FieldArgs<Fields...>
+        void debug(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+            logAt<Level::Debug>(message, location, std::forward<Fields>(fields)...);
         }
 
-        void clearAppenders() {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            appenders.clear();
+        template <typename... Fields>
+            requires detail::FieldArgs<Fields...>
+        void info(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+            logAt<Level::Info>(message, location, std::forward<Fields>(fields)...);
         }
 
-        void append(const LogRecord &record) {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            for (const auto &appender : appenders) {
-                if (appender->isEnabled(record.level, this->level)) {
-                    appender->append(record);
-                }
-            }
+        template <typename... Fields>
+            requires detail::FieldArgs<Fields...>
+        void warn(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+            logAt<Level::Warn>(message, location, std::forward<Fields>(fields)...);
         }
 
-        void flush() {
-            std::lock_guard<std::mutex> lock(appenderMutex);
-            for (auto &appender : appenders) {
-                appender->flush();
-            }
+        template <typename... Fields>
+            requires detail::FieldArgs<Fields...>
+        void error(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+            logAt<Level::Error>(message, location, std::forward<Fields>(fields)...);
         }
 
+        // === rate limited logging ===
+
         /**
-         * @brief Run the logging loop for async mode
-         * @note This will block until the mode is set to Sync or the application exits.
+         * @brief Call-site rate limiter, see everyN, firstN, atMostPer and tokenBucket
+         * @note The limiter decides when a level method or operator bool is called, after the level check and before
+         *       the message is formatted or a record is built, so disabled and rejected calls are cheap and do not
+         *       use up the call site's budget. An accepted line carries a "suppressed" field with the number of lines
+         *       rejected at its call site since the previous line written there. Records use the location of the limiter call.
          */
-        void runLoop() {
-            while (mode == neko::SyncMode::Async) {
-                LogRecord record;
-                {
-                    std::unique_lock<std::mutex> lock(logQueueMutex);
-                    logQueueCondVar.wait_for(lock, std::chrono::milliseconds(500), [this] {
-                        return !logQueue.empty();
-                    });
-                    if (logQueue.empty()) {
-                        continue;
+        class Limited {
+        public:
+            enum class Rule : neko::uint8 {
+                EveryN,
+                FirstN,
+                Token
+            };
+
+        private:
+            Logger &logger;
+            neko::SrcLocInfo location;
+            detail::CallsiteLimit *state;
+            Rule rule;
+            std::uint64_t count;
+            std::chrono::nanoseconds interval;
+            signed char decision = -1; // -1 undecided, 0 rejected, 1 allowed
+            std::uint64_t suppressed = 0;
+
+            /**
+             * @brief Consult the call-site state once; a rejection is counted right away
+             * @note Without state (out of memory for the table) the call is rejected, so limiting never fails open.
+             */
+            bool decide() noexcept {
+                if (decision < 0) {
+                    bool allowed = false;
+                    if (state) {
+                        switch (rule) {
+                            case Rule::EveryN:
+                                allowed = state->everyN(count);
+                                break;
+                            case Rule::FirstN:
+                                allowed = state->firstN(count);
+                                break;
+                            case Rule::Token:
+                                allowed = state->takeToken(interval, count);
+                                break;
+                        }
+                        state->settle(allowed);
                     }
-                    record = logQueue.front();
-                    logQueue.pop();
+                    decision = allowed ? 1 : 0;
                 }
-                append(record);
+                return decision == 1;
             }
 
-            // Flush remaining logs when stopping the loop
-            std::lock_guard<std::mutex> lock(logQueueMutex);
-            while (!logQueue.empty()) {
-                append(logQueue.front());
-                logQueue.pop();
+            bool admit(Level level) noexcept {
+                return logger.isEnabled(level) && decide();
             }
-            flush();
-        }
 
-        /**
-         * @brief Stop the logging loop
-         * @note This will stop the async logging loop and flush any remaining logs.
-         */
-        void stopLoop() {
-            if (mode != neko::SyncMode::Async) {
-                return;
+            // Takes the rejections counted so far, so they are reported by the line actually written
+            std::uint64_t takeSuppressed() noexcept {
+                suppressed = state ? state->take() : 0;
+                return suppressed;
             }
-            std::lock_guard<std::mutex> lock(logQueueMutex);
-            mode = neko::SyncMode::Sync;
-            logQueueCondVar.notify_all();
-        }
 
-        // === Logging ===
+            template <typename... Fields>
+            void write(Level level, std::string_view message, Fields &&...fields) {
+                if (const std::uint64_t count = takeSuppressed(); count == 0) {
+                    const std::array<Field, sizeof...(Fields)> list{std::forward<Fields>(fields)...};
+                    logger.log(level, message, location, list);
+                } else {
+                    const std::array<Field, sizeof...(Fields) + 1> list{std::forward<Fields>(fields)..., kv("suppressed", count)};
+                    logger.log(level, message, location, list);
+                }
+            }
 
-        void log(Level level, const std::string &message, const neko::SrcLocInfo &location = {}) {
-            if (!isEnabled(level)) {
-                return;
+            template <typename... Args>
+            void writeFormatted(Level level, std::format_string<Args...> fmt, Args &&...args) {
+                if (const std::uint64_t count = takeSuppressed(); count == 0) {
+                    logger.logFormatted(level, fmt, location, std::forward<Args>(args)...);
+                } else {
+                    const std::array<Field, 1> list{kv("suppressed", count)};
+                    logger.logFormatted(level, list, fmt, location, std::forward<Args>(args)...);
+                }
+            }
+
+        public:
+            /**
+             * @param count n for EveryN and FirstN, the burst size for Token
+             * @param interval Token refill interval
+             * @note The state is shared by limiters of the same logger, call site, rule and parameters.
+             */
+            Limited(Logger &logger, const neko::SrcLocInfo &location, Rule rule, std::uint64_t count, std::chrono::nanoseconds interval = {})
+                : logger(logger), location(location),
+                  state(detail::callsiteLimit({&logger, location.getFile(), location.getLine(), static_cast<neko::uint8>(rule), count, interval.count()})),
+                  rule(rule), count(count), interval(interval) {}
+
+            /**
+             * @brief Whether the call site lets this call through
+             * @note Decides without a level check. Lines logged by hand after it do not take the suppressed count;
+             *       it stays with the call site until one of the level methods writes a line.
+             */
+            explicit operator bool() noexcept {
+                return decide();
             }
 
-            LogRecord record(level, message, location);
+            /**
+             * @brief The suppressed count reported by the last line this limiter wrote
+             */
+            std::uint64_t getSuppressed() const noexcept {
+                return suppressed;
+            }
 
-            if (mode == neko::SyncMode::Sync) {
-                std::lock_guard<std::mutex> lock(appenderMutex);
-                for (const auto &appender : appenders) {
-                    appender->append(record);
+            void debug(std::string_view message) {
+                if constexpr (isActive(Level::Debug)) {
+                    if (admit(Level::Debug)) {
+                        write(Level::Debug, message);
+                    }
                 }
-                return;
             }
 
-            std::lock_guard<std::mutex> lock(logQueueMutex);
-            logQueue.push(record);
-            logQueueCondVar.notify_one();
-        }
+            template <typename... Args>
+                requires(sizeof...(Args) > 0 && detail::FormatArgs<Args...>)
+            void debug(std::format_string<Args...> fmt, Args &&...args) {
+                if constexpr (isActive(Level::Debug)) {
+                    if (admit(Level::Debug)) {
+                        writeFormatted(Level::Debug, fmt, std::forward<Args>(args)...);
+                    }
+                }
+            }
 
-        // === single message logging ===
+            template <typename... Fields>
+                requires detail::FieldArgs<Fields...>
+            void debug(std::string_view message, Fields &&...fields) {
+                if constexpr (isActive(Level::Debug)) {
+                    if (admit(Level::Debug)) {
+                        write(Level::Debug, message, std::forward<Fields>(fields)...);
+                    }
+                }
+            }
 
-        void debug(const std::string &message, const neko::SrcLocInfo &location = {}) {
-            log(Level::Debug, message, location);
-        }
+            void info(std::string_view message) {
+                if constexpr (isActive(Level::Info)) {
+                    if (admit(Level::Info)) {
+                        write(Level::Info, message);
+                    }
+                }
+            }
 
-        void info(const std::string &message, const neko::SrcLocInfo &location = {}) {
-            log(Level::Info, message, location);
-        }
+            template <typename... Args>
+                requires(sizeof...(Args) > 0 && detail::FormatArgs<Args...>)
+            void info(std::format_string<Args...> fmt, Args &&...args) {
+                if constexpr (isActive(Level::Info)) {
+                    if (admit(Level::Info)) {
+                        writeFormatted(Level::Info, fmt, std::forward<Args>(args)...);
+                    }
+                }
+            }
 
-        void warn(const std::string &message, const neko::SrcLocInfo &location = {}) {
-            log(Level::Warn, message, location);
-        }
+            template <typename... Fields>
+                requires detail::FieldArgs<Fields...>
+            void info(std::string_view message, Fields &&...fields) {
+                if constexpr (isActive(Level::Info)) {
+                    if (admit(Level::Info)) {
+                        write(Level::Info, message, std::forward<Fields>(fields)...);
+                    }
+                }
+            }
 
-        void error(const std::string &message, const neko::SrcLocInfo &location = {}) {
-            log(Level::Error, message, location);
-        }
+            void warn(std::string_view message) {
+                if constexpr (isActive(Level::Warn)) {
+                    if (admit(Level::Warn)) {
+                        write(Level::Warn, message);
+                    }
+                }
+            }
 
-        // === formatted message logging ===
+            template <typename... Args>
+                requires(sizeof...(Args) > 0 && detail::FormatArgs<Args...>)
+            void warn(std::format_string<Args...> fmt, Args &&...args) {
+                if constexpr (isActive(Level::Warn)) {
+                    if (admit(Level::Warn)) {
+                        writeFormatted(Level::Warn, fmt, std::forward<Args>(args)...);
+                    }
+                }
+            }
 
-        template <typename... Args>
-        void debug(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
-            auto message = std::format(fmt, std::forward<Args>(args)...);
-            log(Level::Debug, message, location);
+            template <typename... Fields>
+                requires detail::FieldArgs<Fields...>
+            void warn(std::string_view message, Fields &&...fields) {
+                if constexpr (isActive(Level::Warn)) {
+                    if (admit(Level::Warn)) {
+                        write(Level::Warn, message, std::forward<Fields>(fields)...);
+                    }
+                }
+            }
+
+            void error(std::string_view message) {
+                if constexpr (isActive(Level::Error)) {
+                    if (admit(Level::Error)) {
+                        write(Level::Error, message);
+                    }
+                }
+            }
+
+            template <typename... Args>
+                requires(sizeof...(Args) > 0 && detail::FormatArgs<Args...>)
+            void error(std::format_string<Args...> fmt, Args &&...args) {
+                if constexpr (isActive(Level::Error)) {
+                    if (admit(Level::Error)) {
+                        writeFormatted(Level::Error, fmt, std::forward<Args>(args)...);
+                    }
+                }
+            }
+
+            template <typename... Fields>
+                requires detail::FieldArgs<Fields...>
+            void error(std::string_view message, Fields &&...fields) {
+                if constexpr (isActive(Level::Error)) {
+                    if (admit(Level::Error)) {
+                        write(Level::Error, message, std::forward<Fields>(fields)...);
+                    }
+                }
+            }
+        };
+
+        /**
+         * @brief Let through the first of every n calls at this call site, e.g. logger.everyN(100).warn("retrying {}", id)
+         */
+        Limited everyN(std::uint64_t n, const neko::SrcLocInfo &location = {}) {
+            return Limited(*this, location, Limited::Rule::EveryN, n);
         }
 
-        template <typename... Args>
-        void info(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
-            auto message = std::format(fmt, std::forward<Args>(args)...);
-            log(Level::Info, message, location);
+        /**
+         * @brief Let through only the first n calls at this call site
+         */
+        Limited firstN(std::uint64_t n, const neko::SrcLocInfo &location = {}) {
+            return Limited(*this, location, Limited::Rule::FirstN, n);
         }
 
-        template <typename... Args>
-        void warn(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
-            auto message = std::format(fmt, std::forward<Args>(args)...);
-            log(Level::Warn, message, location);
+        /**
+         * @brief Let through at most one call per interval at this call site
+         */
+        Limited atMostPer(std::chrono::nanoseconds interval, const neko::SrcLocInfo &location = {}) {
+            return Limited(*this, location, Limited::Rule::Token, 1, interval);
         }
 
-        template <typename... Args>
-        void error(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
-            auto message = std::format(fmt, std::forward<Args>(args)...);
-            log(Level::Error, message, location);
+        /**
+         * @brief Let through calls at this call site at ratePerSecond on average, with bursts of up to burst calls
+         */
+        Limited tokenBucket(double ratePerSecond, std::uint64_t burst, const neko::SrcLocInfo &location = {}) {
+            const auto interval = std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 / std::max(ratePerSecond, 1e-9)));
+            return Limited(*this, location, Limited::Rule::Token, burst, interval);
         }
     }
 #if !defined(NEKO_LOG_ENABLE_MODULE) || (NEKO_LOG_ENABLE_MODULE == false)
@@ -636,6 +5230,15 @@ namespace neko::log {
     inline neko::SyncMode getMode() {
         return logger.getMode();
     }
+    inline std::size_t getQueueCapacity() {
+        return logger.getQueueCapacity();
+    }
+    inline OverflowPolicy getOverflowPolicy() {
+        return logger.getOverflowPolicy();
+    }
+    inline std::uint64_t getDroppedCount() {
+        return logger.getDroppedCount();
+    }
 
     inline bool isEnabled(Level level) {
         return logger.isEnabled(level);
@@ -651,6 +5254,14 @@ namespace neko::log {
         logger.setMode(m);
     }
 
+    inline bool setQueueCapacity(std::size_t capacity) {
+        return logger.setQueueCapacity(capacity);
+    }
+
+    inline void setOverflowPolicy(OverflowPolicy policy, Level level = Level::Warn) {
+        logger.setOverflowPolicy(policy, level);
+    }
+
     inline void addFileAppender(const std::string &filename, bool isTruncate = false, std::unique_ptr<IFormatter> formatter = std::make_unique<DefaultFormatter>()) {
         logger.addFileAppender(filename, isTruncate, std::move(formatter));
     }
@@ -686,43 +5297,146 @@ namespace neko::log {
         logger.stopLoop();
     }
 
+    inline bool startAsync(const AsyncOptions &options = {}) {
+        return logger.startAsync(options);
+    }
+    inline void stopAsync() {
+        logger.stopAsync();
+    }
+
+    inline bool installCrashHandler(const std::string &filename = "", bool toStderr = true, std::size_t bufferSize = 64 * 1024) {
+        return logger.installCrashHandler(filename, toStderr, bufferSize);
+    }
+    inline void removeCrashHandler() {
+        logger.removeCrashHandler();
+    }
+
+    /**
+     * @brief Give the calling thread an alternate signal stack, so the crash handler also runs after a stack overflow on it
+     * @note installCrashHandler does this for the thread that calls it. Returns false if crash handling is unavailable.
+     */
+    inline bool installCrashStack() {
+#if NEKO_LOG_HAS_CRASH_HANDLER
+        return detail::installAltStack();
+#else
+        return false;
+#endif
+    }
+
     // === Logging ===
 
-    inline void debug(const std::string &message, const neko::SrcLocInfo &location = {}) {
+    inline void debug(std::string_view message, const neko::SrcLocInfo &location = {}) {
         logger.debug(message, location);
     }
 
-    inline void info(const std::string &message, const neko::SrcLocInfo &location = {}) {
+    inline void info(std::string_view message, const neko::SrcLocInfo &location = {}) {
         logger.info(message, location);
     }
 
-    inline void warn(const std::string &message, const neko::SrcLocInfo &location = {}) {
+    inline void warn(std::string_view message, const neko::SrcLocInfo &location = {}) {
         logger.warn(message, location);
     }
 
-    inline void error(const std::string &message, const neko::SrcLocInfo &location = {}) {
+    inline void error(std::string_view message, const neko::SrcLocInfo &location = {}) {
         logger.error(message, location);
     }
 
+    template <MessageProducer F>
+    void debug(F &&producer, const neko::SrcLocInfo &location = {}) {
+        logger.debug(std::forward<F>(producer), location);
+    }
+    template <MessageProducer F>
+    void info(F &&producer, const neko::SrcLocInfo &location = {}) {
+        logger.info(std::forward<F>(producer), location);
+    }
+    template <MessageProducer F>
+    void warn(F &&producer, const neko::SrcLocInfo &location = {}) {
+        logger.warn(std::forward<F>(producer), location);
+    }
+    template <MessageProducer F>
+    void error(F &&producer, const neko::SrcLocInfo &location = {}) {
+        logger.error(std::forward<F>(producer), location);
+    }
+
     template <typename... Args>
+        requires detail::FormatArgs<Args...>
     void debug(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
-        auto message = std::format(fmt, std::forward<Args>(args)...);
-        logger.debug(message, location);
+        logger.debug(fmt, location, std::forward<Args>(args)...);
     }
     template <typename... Args>
+        requires detail::FormatArgs<Args...>
     void info(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
-        auto message = std::format(fmt, std::forward<Args>(args)...);
-        logger.info(message, location);
+        logger.info(fmt, location, std::forward<Args>(args)...);
     }
     template <typename... Args>
+        requires detail::FormatArgs<Args...>
     void warn(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
-        auto message = std::format(fmt, std::forward<Args>(args)...);
-        logger.warn(message, location);
+        logger.warn(fmt, location, std::forward<Args>(args)...);
     }
     template <typename... Args>
+        requires detail::FormatArgs<Args...>
     void error(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
-        auto message = std::format(fmt, std::forward<Args>(args)...);
-        logger.error(message, location);
+        logger.error(fmt, location, std::forward<Args>(args)...);
+    }
+
+    template <Level Lv>
+    void logAt(std::string_view message, const neko::SrcLocInfo &location = {}) {
+        logger.logAt<Lv>(message, location);
+    }
+    template <Level Lv, MessageProducer F>
+    void logAt(F &&producer, const neko::SrcLocInfo &location = {}) {
+        logger.logAt<Lv>(std::forward<F>(producer), location);
+    }
+    template <Level Lv, typename... Args>
+        requires(sizeof...(Args) > 0 && detail::FormatArgs<Args...>)
+    void logAt(std::format_string<Args...> fmt, const neko::SrcLocInfo &location, Args &&...args) {
+        logger.logAt<Lv>(fmt, location, std::forward<Args>(args)...);
+    }
+    template <typename... Fields>
+        requires detail::FieldArgs<Fields...>
+    void debug(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+        logger.debug(message, location, std::forward<Fields>(fields)...);
+    }
+    template <typename... Fields>
+        requires detail::FieldArgs<Fields...>
+    void info(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+        logger.info(message, location, std::forward<Fields>(fields)...);
+    }
+    template <typename... Fields>
+        requires detail::FieldArgs<Fields...>
+    void warn(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+        logger.warn(message, location, std::forward<Fields>(fields)...);
+    }
+    template <typename... Fields>
+        requires detail::FieldArgs<Fields...>
+    void error(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+        logger.error(message, location, std::forward<Fields>(fields)...);
+    }
+    template <Level Lv, typename... Fields>
+        requires detail::FieldArgs<Fields...>
+    void logAt(std::string_view message, const neko::SrcLocInfo &location, Fields &&...fields) {
+        logger.logAt<Lv>(message, location, std::forward<Fields>(fields)...);
+    }
+
+    // === Rate limiting ===
+
+    /**
+     * @brief Let through the first of every n calls at this call site, e.g. log::everyN(100).warn("retrying {}", id)
+     */
+    inline Logger::Limited everyN(std::uint64_t n, const neko::SrcLocInfo &location = {}) {
+        return logger.everyN(n, location);
+    }
+
+    inline Logger::Limited firstN(std::uint64_t n, const neko::SrcLocInfo &location = {}) {
+        return logger.firstN(n, location);
+    }
+
+    inline Logger::Limited atMostPer(std::chrono::nanoseconds interval, const neko::SrcLocInfo &location = {}) {
+        return logger.atMostPer(interval, location);
+    }
+
+    inline Logger::Limited tokenBucket(double ratePerSecond, std::uint64_t burst, const neko::SrcLocInfo &location = {}) {
+        return logger.tokenBucket(ratePerSecond, burst, location);
     }
 
     /**
@@ -2,18 +2,180 @@
 #include <neko/log/nlog.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <span>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
+#if NEKO_LOG_HAS_MMAP
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
 using namespace neko;
 
+// Skip a test whose premise needs statements at this level, which NEKO_LOG_ACTIVE_LEVEL may compile out
+#define SKIP_UNLESS_ACTIVE(level)                                                          \
+    if constexpr (!log::isActive(level)) {                                                 \
+        GTEST_SKIP() << #level " statements are compiled out by NEKO_LOG_ACTIVE_LEVEL";    \
+    }
+
+// Counting allocator, enabled only while a test measures allocations.
+// Every replaceable form is defined so that each new/delete pair goes
+// through the same malloc/free (or aligned) implementation.
+namespace {
+    std::atomic<bool> countAllocations = false;
+    std::atomic<std::size_t> allocationCount = 0;
+
+    void *countedAlloc(std::size_t size) {
+        if (countAllocations.load(std::memory_order_relaxed)) {
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void *countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+        if (countAllocations.load(std::memory_order_relaxed)) {
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        auto alignment = static_cast<std::size_t>(align);
+        if (alignment < sizeof(void *)) {
+            alignment = sizeof(void *);
+        }
+#ifdef _WIN32
+        return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+        void *ptr = nullptr;
+        return posix_memalign(&ptr, alignment, size == 0 ? 1 : size) == 0 ? ptr : nullptr;
+#endif
+    }
+
+    void countedAlignedFree(void *ptr) noexcept {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+} // namespace
+
+// GCC inlines these definitions into callers and then flags the free() as not
+// matching the built-in operator new, even though both sides are replaced here.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t size) {
+    if (void *ptr = countedAlloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    if (void *ptr = countedAlloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    if (void *ptr = countedAlignedAlloc(size, align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+    if (void *ptr = countedAlignedAlloc(size, align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return countedAlignedAlloc(size, align);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return countedAlignedAlloc(size, align);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    countedAlignedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    countedAlignedFree(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    countedAlignedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    countedAlignedFree(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    countedAlignedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    countedAlignedFree(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 // Test utilities
 class TestAppender : public log::IAppender {
 private:
@@ -90,14 +252,390 @@ TEST(NLogTest, FileLogging) {
     // Clean up test file
     std::filesystem::remove(testFile);
 
-    // Verify all log levels were found
-    EXPECT_TRUE(foundInfo) << "Info log entry not found in file";
-    EXPECT_TRUE(foundWarn) << "Warn log entry not found in file";
-    EXPECT_TRUE(foundError) << "Error log entry not found in file";
+    // Verify every active log level was found
+    EXPECT_EQ(foundInfo, log::isActive(log::Level::Info)) << "Info log entry";
+    EXPECT_EQ(foundWarn, log::isActive(log::Level::Warn)) << "Warn log entry";
+    EXPECT_EQ(foundError, log::isActive(log::Level::Error)) << "Error log entry";
+}
+
+// Buffered file appender test
+TEST(NLogTest, BufferedFileAppender) {
+    const std::string testFile = "test_buffered_log.txt";
+    {
+        log::FileAppender appender(testFile, true);
+        appender.setFlushPolicy(log::FlushPolicy::buffered(64 * 1024, std::chrono::hours(1), log::Level::Error));
+        const auto headerSize = std::filesystem::file_size(testFile);
+
+        // Below the size, age and level thresholds nothing reaches the file
+        appender.append(log::LogRecord(log::Level::Info, "buffered info"));
+        appender.append(log::LogRecord(log::Level::Warn, "buffered warn"));
+        EXPECT_EQ(std::filesystem::file_size(testFile), headerSize);
+
+        // An Error record flushes everything buffered before it
+        appender.append(log::LogRecord(log::Level::Error, "flushing error"));
+        const auto afterError = std::filesystem::file_size(testFile);
+        EXPECT_GT(afterError, headerSize);
+
+        // Explicit flush still writes everything appended so far
+        appender.append(log::LogRecord(log::Level::Info, "explicit flush"));
+        EXPECT_EQ(std::filesystem::file_size(testFile), afterError);
+        appender.flush();
+        EXPECT_GT(std::filesystem::file_size(testFile), afterError);
+
+        // A full buffer is written without waiting for the interval
+        appender.setFlushPolicy(log::FlushPolicy::buffered(1, std::chrono::hours(1), log::Level::Off));
+        const auto beforeFull = std::filesystem::file_size(testFile);
+        appender.append(log::LogRecord(log::Level::Debug, "buffer full"));
+        EXPECT_GT(std::filesystem::file_size(testFile), beforeFull);
+    }
+
+    std::ifstream file(testFile);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(testFile);
+
+    const auto info = content.find("buffered info");
+    const auto warn = content.find("buffered warn");
+    const auto error = content.find("flushing error");
+    ASSERT_NE(info, std::string::npos);
+    ASSERT_NE(warn, std::string::npos);
+    ASSERT_NE(error, std::string::npos);
+    EXPECT_LT(info, warn);
+    EXPECT_LT(warn, error);
+    EXPECT_NE(content.find("explicit flush"), std::string::npos);
+    EXPECT_NE(content.find("buffer full"), std::string::npos);
+}
+
+// Idle flush test: behind a background writer, a buffered appender is written once records stop arriving
+TEST(NLogTest, BufferedFileIdleFlush) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    const std::string backendFile = "test_idle_backend.txt";
+    const std::string asyncFile = "test_idle_async.txt";
+    const auto waitForGrowth = [](const std::string &path, std::uintmax_t size) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::filesystem::file_size(path) == size && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return std::filesystem::file_size(path) > size;
+    };
+    const auto policy = log::FlushPolicy::buffered(1024 * 1024, std::chrono::milliseconds(20), log::Level::Off);
+    {
+        log::Logger logger(log::Level::Info);
+        logger.clearAppenders();
+
+        auto backendAppender = std::make_unique<log::FileAppender>(backendFile, true);
+        backendAppender->setFlushPolicy(policy);
+        logger.addAppender(std::move(backendAppender));
+
+        auto asyncInner = std::make_unique<log::FileAppender>(asyncFile, true);
+        asyncInner->setFlushPolicy(policy);
+        logger.addAppender(std::make_unique<log::AsyncAppender>(std::move(asyncInner)));
+
+        const auto backendSize = std::filesystem::file_size(backendFile);
+        const auto asyncSize = std::filesystem::file_size(asyncFile);
+        ASSERT_TRUE(logger.startAsync());
+        logger.info("idle record");
+
+        // No further record and no flush(): the backend and the AsyncAppender worker write it when they go idle
+        EXPECT_TRUE(waitForGrowth(backendFile, backendSize));
+        EXPECT_TRUE(waitForGrowth(asyncFile, asyncSize));
+        logger.stopAsync();
+    }
+    for (const auto &path : {backendFile, asyncFile}) {
+        std::ifstream file(path);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+        std::filesystem::remove(path);
+        EXPECT_NE(content.find("idle record"), std::string::npos) << path;
+    }
+}
+
+// Rotating file appender test
+TEST(NLogTest, RotatingFileAppender) {
+    const std::filesystem::path dir = "test_rotating_logs";
+    std::filesystem::remove_all(dir);
+
+    auto countFiles = [&dir] {
+        return std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator{});
+    };
+
+    {
+        log::RotationPolicy policy;
+        policy.maxFileSize = 256;
+        policy.maxFiles = 3;
+        log::RotatingFileAppender appender((dir / "app.log").string(), policy);
+        EXPECT_EQ(appender.getActivePath(), dir / "app.1.log");
+
+        auto activeIndex = [&appender] {
+            const std::string name = appender.getActivePath().filename().string();
+            return std::stoul(name.substr(4, name.size() - 8));
+        };
+
+        // Rotation never waits for the worker, so keep appending until it has prepared a few files
+        for (int i = 0; i < 5000 && activeIndex() < 5; ++i) {
+            appender.append(log::LogRecord(log::Level::Info, "size rotation " + std::to_string(i)));
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        EXPECT_GE(activeIndex(), 5u);
+
+        // Only the prepared file, still empty, can have a higher number than the active one
+        for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+            const std::string name = entry.path().filename().string();
+            const std::size_t index = std::stoul(name.substr(4, name.size() - 8));
+            EXPECT_LE(index, activeIndex() + 1) << name;
+            if (index > activeIndex()) {
+                EXPECT_EQ(std::filesystem::file_size(entry.path()), 0u) << name;
+            }
+        }
+    }
+
+    // Retention keeps the newest files and the last record is in the newest one
+    EXPECT_EQ(countFiles(), 3);
+    EXPECT_FALSE(std::filesystem::exists(dir / "app.1.log"));
+
+    std::filesystem::path newest;
+    {
+        log::RotationPolicy policy;
+        policy.schedule = log::RotationSchedule::Hourly;
+        policy.timeZone = log::TimeZone::Utc;
+        log::RotatingFileAppender appender((dir / "app.log").string(), policy);
+        const auto first = appender.getActivePath();
+
+        log::LogRecord record(log::Level::Info, "this hour");
+        appender.append(record);
+        EXPECT_EQ(appender.getActivePath(), first);
+
+        // Records due for rotation stay in the current file until the worker has the next one ready
+        record.message = "next hour";
+        record.timestamp += std::chrono::hours(1);
+        for (int i = 0; i < 5000 && appender.getActivePath() == first; ++i) {
+            appender.append(record);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        appender.append(record);
+        newest = appender.getActivePath();
+        EXPECT_NE(newest, first);
+    }
+
+    std::ifstream file(newest);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove_all(dir);
+
+    EXPECT_NE(content.find("next hour"), std::string::npos);
+    EXPECT_EQ(content.find("this hour"), std::string::npos);
+
+    // Leftovers from a crashed run: an empty prepared file and a number too long to parse
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "app.6.log").put('x');
+    std::ofstream(dir / "app.7.log").flush();
+    std::ofstream(dir / "app.99999999999999999999999999.log").put('x');
+    {
+        log::RotationPolicy policy;
+        policy.maxFiles = 1;
+        log::RotatingFileAppender appender((dir / "app.log").string(), policy);
+        EXPECT_EQ(appender.getActivePath(), dir / "app.7.log");
+    }
+    EXPECT_FALSE(std::filesystem::exists(dir / "app.6.log"));
+    EXPECT_FALSE(std::filesystem::exists(dir / "app.8.log"));
+    EXPECT_TRUE(std::filesystem::exists(dir / "app.99999999999999999999999999.log"));
+    std::filesystem::remove_all(dir);
+}
+
+#if NEKO_LOG_HAS_MMAP
+// Memory-mapped file appender test
+TEST(NLogTest, MmapFileAppender) {
+    const std::string testFile = "test_mmap_log.txt";
+    {
+        // One-page windows so the records span several window rolls
+        log::MmapFileAppender appender(testFile, true, 1);
+        EXPECT_GT(appender.getWindowSize(), 0u);
+        for (int i = 0; i < 200; ++i) {
+            appender.append(log::LogRecord(log::Level::Info, "mmap record " + std::to_string(i)));
+        }
+    }
+    {
+        // Appending continues after the existing content
+        log::MmapFileAppender appender(testFile, false, 1);
+        appender.append(log::LogRecord(log::Level::Info, "mmap appended"));
+    }
+
+    std::ifstream file(testFile, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(testFile);
+
+    // Truncated to the bytes written, without zero padding
+    EXPECT_EQ(content.find('\0'), std::string::npos);
+    ASSERT_FALSE(content.empty());
+    EXPECT_EQ(content.back(), '\n');
+    EXPECT_EQ(std::count(content.begin(), content.end(), '\n'), 201);
+
+    std::size_t previous = 0;
+    for (int i = 0; i < 200; ++i) {
+        const auto pos = content.find("mmap record " + std::to_string(i) + "\n");
+        ASSERT_NE(pos, std::string::npos) << "missing record " << i;
+        EXPECT_GE(pos, previous);
+        previous = pos;
+    }
+    EXPECT_GT(content.find("mmap appended"), previous);
+
+    // A window that cannot be reserved drops records instead of faulting, and the next append retries
+    EXPECT_EXIT({
+        ::signal(SIGXFSZ, SIG_IGN);
+        rlimit limit{};
+        ::getrlimit(RLIMIT_FSIZE, &limit);
+        const rlim_t unlimited = limit.rlim_cur;
+        {
+            log::MmapFileAppender appender(testFile, true, 1);
+            limit.rlim_cur = 64 * 1024;
+            ::setrlimit(RLIMIT_FSIZE, &limit);
+            for (int i = 0; i < 4000; ++i) {
+                appender.append(log::LogRecord(log::Level::Info, "over the limit " + std::to_string(i)));
+            }
+            limit.rlim_cur = unlimited;
+            ::setrlimit(RLIMIT_FSIZE, &limit);
+            appender.append(log::LogRecord(log::Level::Info, "space again"));
+        }
+        std::ifstream file(testFile, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const bool kept = content.find("over the limit 0\n") != std::string::npos;
+        const bool resumed = content.find("space again\n") != std::string::npos;
+        std::exit(kept && resumed ? 0 : 1);
+    },
+                ::testing::ExitedWithCode(0), "");
+    std::filesystem::remove(testFile);
 }
+#endif
+
+// Binary appender and reader test
+TEST(NLogTest, BinaryAppender) {
+    const std::string testFile = "test_binary_log.bin";
+    log::setCurrentThreadName("BinaryThread");
+
+    std::vector<log::LogRecord> records;
+    for (int i = 0; i < 20; ++i) {
+        records.emplace_back(i % 2 ? log::Level::Warn : log::Level::Info, "binary record " + std::to_string(i));
+    }
+    records.emplace_back(log::Level::Error, "");
+    {
+        log::BinaryAppender appender(testFile, true);
+        for (const auto &record : records) {
+            appender.append(record);
+        }
+    }
+    {
+        // Appending starts a new segment with its own interned names
+        log::BinaryAppender appender(testFile);
+        appender.append(records.front());
+    }
+    records.push_back(records.front());
+
+    // Decoding reproduces the DefaultFormatter text exactly
+    log::DefaultFormatter expected;
+    log::DefaultFormatter decoded;
+    std::size_t count = 0;
+    {
+        std::ifstream in(testFile, std::ios::binary);
+        log::BinaryLogReader reader(in);
+        log::BinaryLogReader::Entry entry;
+        while (reader.next(entry)) {
+            ASSERT_LT(count, records.size());
+            EXPECT_EQ(decoded.formatFields(entry.level, entry.timestamp, entry.threadName, entry.file, entry.line, entry.message),
+                      expected.format(records[count]));
+            ++count;
+        }
+        EXPECT_FALSE(reader.isIncomplete());
+    }
+    EXPECT_EQ(count, records.size());
+
+    std::string full;
+    {
+        std::ifstream in(testFile, std::ios::binary);
+        full.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto readAll = [](const std::string &bytes, std::size_t &read) {
+        std::istringstream in(bytes);
+        log::BinaryLogReader reader(in);
+        log::BinaryLogReader::Entry entry;
+        read = 0;
+        while (reader.next(entry)) {
+            ++read;
+        }
+        return reader.isIncomplete();
+    };
+
+    // A segment header torn at the tail, or a frame claiming more bytes than the file holds, ends the log as incomplete
+    std::size_t read = 0;
+    EXPECT_TRUE(readAll(full + "NLO", read));
+    EXPECT_EQ(read, records.size());
+    EXPECT_TRUE(readAll(full + "\x03\xff\xff\xff\xff\xff\xff\xff\xff\x7f" + std::string(16, 'x'), read));
+    EXPECT_EQ(read, records.size());
+    EXPECT_TRUE(readAll("NL", read));
+    EXPECT_EQ(read, 0u);
+
+    // A file cut inside the last frame reads back up to the last complete frame
+    std::filesystem::resize_file(testFile, std::filesystem::file_size(testFile) - 3);
+    count = 0;
+    {
+        std::ifstream in(testFile, std::ios::binary);
+        log::BinaryLogReader reader(in);
+        log::BinaryLogReader::Entry entry;
+        while (reader.next(entry)) {
+            ++count;
+        }
+        EXPECT_TRUE(reader.isIncomplete());
+    }
+    std::filesystem::remove(testFile);
+    EXPECT_EQ(count, records.size() - 1);
+
+    std::istringstream notBinary("plain text log");
+    EXPECT_THROW(log::BinaryLogReader{notBinary}, ex::FileError);
+}
+
+#if defined(NEKO_LOG_DECODE_PATH) && !defined(_WIN32)
+// nlog-decode writes exactly the DefaultFormatter text to standard output
+TEST(NLogTest, DecodeTool) {
+    const std::string testFile = "test_decode_tool.nlog";
+    log::setCurrentThreadName("DecodeThread");
+
+    std::vector<log::LogRecord> records;
+    for (int i = 0; i < 5; ++i) {
+        records.emplace_back(i % 2 ? log::Level::Warn : log::Level::Info, "decoded record " + std::to_string(i));
+    }
+    {
+        log::BinaryAppender appender(testFile, true);
+        for (const auto &record : records) {
+            appender.append(record);
+        }
+    }
+
+    log::DefaultFormatter formatter("", true, log::TimeZone::Utc);
+    std::string expected;
+    for (const auto &record : records) {
+        expected += formatter.format(record) + "\n";
+    }
+
+    std::string output;
+    const std::string command = std::string(NEKO_LOG_DECODE_PATH) + " --utc --full-path " + testFile;
+    FILE *pipe = ::popen(command.c_str(), "r");
+    ASSERT_NE(pipe, nullptr);
+    char chunk[4096];
+    for (std::size_t n; (n = std::fread(chunk, 1, sizeof(chunk), pipe)) > 0;) {
+        output.append(chunk, n);
+    }
+    EXPECT_EQ(::pclose(pipe), 0);
+    std::filesystem::remove(testFile);
+
+    EXPECT_EQ(output, expected);
+}
+#endif
 
 // Thread name test
 TEST(NLogTest, ThreadName) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
     // Clear appenders before starting the test
     log::clearAppenders();
     
@@ -177,6 +715,63 @@ TEST(NLogTest, ThreadName) {
     log::clearAppenders();
 }
 
+// Thread name cache invalidation and cleanup test
+TEST(NLogTest, ThreadNameCache) {
+    log::ThreadNameManager manager;
+
+    std::thread worker([&manager] {
+        manager.setCurrentThreadName("Worker A");
+        EXPECT_EQ(manager.getCurrentThreadName(), "Worker A");
+
+        // Renaming from the same or another thread must invalidate the cached name
+        manager.setCurrentThreadName("Worker B");
+        EXPECT_EQ(manager.getCurrentThreadName(), "Worker B");
+
+        std::thread renamer([&manager, id = std::this_thread::get_id()] {
+            manager.setThreadName(id, "Worker C");
+        });
+        renamer.join();
+        EXPECT_EQ(manager.getCurrentThreadName(), "Worker C");
+        EXPECT_EQ(manager.getNameCount(), 1u);
+    });
+    worker.join();
+
+    // The entry is removed automatically when the thread exits
+    EXPECT_EQ(manager.getNameCount(), 0u);
+    EXPECT_EQ(manager.getCurrentThreadName().rfind("Thread ", 0), 0u);
+
+    // A held name outlives its thread and a later rename
+    log::ThreadName held;
+    std::thread named([&manager, &held] {
+        manager.setCurrentThreadName("Short lived");
+        held = manager.getCurrentThreadNameRef();
+        manager.setCurrentThreadName("Renamed");
+        EXPECT_EQ(manager.getCurrentThreadNameRef(), "Renamed");
+    });
+    named.join();
+    EXPECT_EQ(held, "Short lived");
+
+    // Renaming another thread leaves this thread's cached name alone
+    const log::ThreadName &own = manager.getCurrentThreadNameRef();
+    const log::ThreadName before = own;
+    std::thread other([&manager] { manager.setCurrentThreadName("Other"); });
+    other.join();
+    EXPECT_EQ(manager.getCurrentThreadNameRef(), before);
+}
+
+// Records own names assigned from temporaries
+TEST(NLogTest, ThreadNameOwnership) {
+    log::LogRecord record;
+    record.threadName = std::string("temporary-") + std::to_string(42);
+    log::LogRecord copy = record;
+    record.threadName = "literal";
+
+    EXPECT_EQ(copy.threadName, "temporary-42");
+    EXPECT_EQ(record.threadName.view(), "literal");
+    EXPECT_EQ(std::string(copy.threadName), "temporary-42");
+    EXPECT_TRUE(log::ThreadName().empty());
+}
+
 // Log level filtering test
 TEST(NLogTest, LogLevelFiltering) {
     log::clearAppenders();
@@ -210,16 +805,77 @@ TEST(NLogTest, LogLevelFiltering) {
     
     log::flushLog();
     
+    // Only warn and error pass the runtime level, if NEKO_LOG_ACTIVE_LEVEL kept them
+    constexpr bool warnActive = log::isActive(log::Level::Warn);
+    constexpr bool errorActive = log::isActive(log::Level::Error);
     const auto& messages = appenderPtr->getMessages();
-    EXPECT_EQ(messages.size(), 2) << "Only warn and error messages should be logged";
-    EXPECT_TRUE(appenderPtr->containsMessage("warning should appear"));
-    EXPECT_TRUE(appenderPtr->containsMessage("error should appear"));
+    EXPECT_EQ(messages.size(), std::size_t{warnActive} + errorActive) << "Only warn and error messages should be logged";
+    EXPECT_EQ(appenderPtr->containsMessage("warning should appear"), warnActive);
+    EXPECT_EQ(appenderPtr->containsMessage("error should appear"), errorActive);
     
     // Clean up
     log::setLevel(log::Level::Debug);
     log::clearAppenders();
 }
 
+// Lazily evaluated messages are only produced when the level is enabled
+TEST(NLogTest, LazyLogging) {
+    log::clearAppenders();
+
+    auto testAppender = std::make_unique<TestAppender>();
+    auto *appenderPtr = testAppender.get();
+    log::addAppender(std::move(testAppender));
+    log::setLevel(log::Level::Info);
+
+    int evaluations = 0;
+    auto expensive = [&evaluations] {
+        ++evaluations;
+        return std::string("expensive message");
+    };
+
+    log::debug(expensive);
+    EXPECT_EQ(evaluations, 0) << "Producer must not run for a disabled level";
+    EXPECT_TRUE(appenderPtr->getMessages().empty());
+
+    // A compiled-out statement never runs the producer either
+    constexpr bool infoActive = log::isActive(log::Level::Info);
+    log::info(expensive);
+    EXPECT_EQ(evaluations, infoActive ? 1 : 0);
+    EXPECT_EQ(appenderPtr->containsMessage("expensive message"), infoActive);
+    EXPECT_EQ(appenderPtr->containsMessage("[Info]"), infoActive);
+
+    log::setLevel(log::Level::Debug);
+    log::clearAppenders();
+}
+
+// Compile-time level entry point
+TEST(NLogTest, CompileTimeLevel) {
+    static_assert(log::isActive(log::Level::Error) == (log::activeLevel <= log::Level::Error));
+    static_assert(log::isActive(log::Level::Debug) == (log::activeLevel <= log::Level::Debug));
+
+    log::clearAppenders();
+
+    auto testAppender = std::make_unique<TestAppender>();
+    auto *appenderPtr = testAppender.get();
+    log::addAppender(std::move(testAppender));
+    log::setLevel(log::Level::Debug);
+
+    log::logAt<log::Level::Warn>("plain message");
+    log::logAt<log::Level::Error>("formatted {}", {}, 42);
+    log::logAt<log::Level::Info>([] { return std::string("lazy message"); });
+
+    // Statements below NEKO_LOG_ACTIVE_LEVEL are compiled out
+    constexpr bool warnActive = log::isActive(log::Level::Warn);
+    constexpr bool errorActive = log::isActive(log::Level::Error);
+    constexpr bool infoActive = log::isActive(log::Level::Info);
+    EXPECT_EQ(appenderPtr->getMessages().size(), std::size_t{warnActive} + errorActive + infoActive);
+    EXPECT_EQ(appenderPtr->containsMessage("[Warn]"), warnActive);
+    EXPECT_EQ(appenderPtr->containsMessage("formatted 42"), errorActive);
+    EXPECT_EQ(appenderPtr->containsMessage("lazy message"), infoActive);
+
+    log::clearAppenders();
+}
+
 // Basic logging functionality test
 TEST(NLogTest, BasicLogging) {
     log::clearAppenders();
@@ -240,26 +896,32 @@ TEST(NLogTest, BasicLogging) {
     
     const auto& messages = appenderPtr->getMessages();
     
-    // Verify all messages were logged
-    EXPECT_EQ(messages.size(), 4) << "All four log messages should be captured";
+    // Verify all messages were logged; levels below NEKO_LOG_ACTIVE_LEVEL are compiled out
+    constexpr bool debugActive = log::isActive(log::Level::Debug);
+    constexpr bool infoActive = log::isActive(log::Level::Info);
+    constexpr bool warnActive = log::isActive(log::Level::Warn);
+    constexpr bool errorActive = log::isActive(log::Level::Error);
+    EXPECT_EQ(messages.size(), std::size_t{debugActive} + infoActive + warnActive + errorActive) << "All active log messages should be captured";
     
     // Verify content
-    EXPECT_TRUE(appenderPtr->containsMessage("debug log message"));
-    EXPECT_TRUE(appenderPtr->containsMessage("info log message"));
-    EXPECT_TRUE(appenderPtr->containsMessage("warning log message"));
-    EXPECT_TRUE(appenderPtr->containsMessage("error log message"));
+    EXPECT_EQ(appenderPtr->containsMessage("debug log message"), debugActive);
+    EXPECT_EQ(appenderPtr->containsMessage("info log message"), infoActive);
+    EXPECT_EQ(appenderPtr->containsMessage("warning log message"), warnActive);
+    EXPECT_EQ(appenderPtr->containsMessage("error log message"), errorActive);
     
     // Verify log levels appear in formatted output
-    EXPECT_TRUE(appenderPtr->containsMessage("[Debug]"));
-    EXPECT_TRUE(appenderPtr->containsMessage("[Info]"));
-    EXPECT_TRUE(appenderPtr->containsMessage("[Warn]"));
-    EXPECT_TRUE(appenderPtr->containsMessage("[Error]"));
+    EXPECT_EQ(appenderPtr->containsMessage("[Debug]"), debugActive);
+    EXPECT_EQ(appenderPtr->containsMessage("[Info]"), infoActive);
+    EXPECT_EQ(appenderPtr->containsMessage("[Warn]"), warnActive);
+    EXPECT_EQ(appenderPtr->containsMessage("[Error]"), errorActive);
     
     log::clearAppenders();
 }
 
 // Custom formatter test
 TEST(NLogTest, CustomFormatter) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
     class TestFormatter : public log::IFormatter {
     public:
         std::string format(const log::LogRecord &record) override {
@@ -287,6 +949,320 @@ TEST(NLogTest, CustomFormatter) {
     log::clearAppenders();
 }
 
+// formatTo appends into a caller buffer; formatters that only implement format() go through the default adapter
+TEST(NLogTest, FormatTo) {
+    log::DefaultFormatter formatter;
+    log::LogRecord record(log::Level::Warn, "into the buffer");
+
+    std::string buffer = "prefix|";
+    formatter.formatTo(record, buffer);
+    EXPECT_EQ(buffer, "prefix|" + formatter.format(record));
+
+    class LegacyFormatter : public log::IFormatter {
+    public:
+        std::string format(const log::LogRecord &record) override {
+            return "legacy " + record.message;
+        }
+    };
+
+    std::string filename = "format_to_test.log";
+    std::filesystem::remove(filename);
+    {
+        log::FileAppender appender(filename, true, std::make_unique<LegacyFormatter>());
+        appender.append(record);
+        appender.append(log::LogRecord(log::Level::Info, "second"));
+    }
+
+    std::ifstream file(filename);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        lines.push_back(line);
+    }
+    ASSERT_GE(lines.size(), 2u);
+    EXPECT_EQ(lines[lines.size() - 2], "legacy into the buffer");
+    EXPECT_EQ(lines.back(), "legacy second");
+    file.close();
+    std::filesystem::remove(filename);
+}
+
+// Pattern formatter: compiled pattern fields and parity with DefaultFormatter
+TEST(NLogTest, PatternFormatter) {
+    log::LogRecord record(log::Level::Error, "pattern message");
+    record.timestamp = std::chrono::sys_days(std::chrono::year(2025) / 3 / 4) + std::chrono::hours(5) +
+                       std::chrono::minutes(6) + std::chrono::seconds(7) + std::chrono::microseconds(8009);
+
+    log::PatternFormatter defaultLayout(log::PatternFormatter::defaultPattern, log::TimeZone::Utc);
+    log::DefaultFormatter reference("", false, log::TimeZone::Utc);
+    EXPECT_EQ(defaultLayout.format(record), reference.format(record));
+
+    record.threadName = "worker";
+    log::PatternFormatter custom("%d/%m/%Y %H:%M:%S.%f %% %l|%t|%#|%v", log::TimeZone::Utc);
+    EXPECT_EQ(custom.format(record),
+              "04/03/2025 05:06:07.008009 % Error|worker|" + std::to_string(record.location.getLine()) + "|pattern message");
+
+    log::PatternFormatter paths("%s %g %!");
+    std::string expected = std::filesystem::path(record.location.getFile()).filename().string() + " " +
+                           record.location.getFile() + " " + record.location.getFuncName();
+    EXPECT_EQ(paths.format(record), expected);
+
+    EXPECT_THROW(log::PatternFormatter("%q"), neko::ex::InvalidArgument);
+    EXPECT_THROW(log::PatternFormatter("trailing %"), neko::ex::InvalidArgument);
+}
+
+// Structured fields: typed values through the logger, text rendering and the JSON formatter
+TEST(NLogTest, StructuredFields) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    log::clearAppenders();
+    auto testAppender = std::make_unique<TestAppender>();
+    auto *appenderPtr = testAppender.get();
+    log::addAppender(std::move(testAppender));
+
+    log::info("request done", {}, log::kv("status", 200), log::kv("ms", 12.5), log::kv("path", "/api"), log::kv("ok", true));
+    ASSERT_EQ(appenderPtr->getMessages().size(), 1u);
+    EXPECT_TRUE(appenderPtr->containsMessage("request done status=200 ms=12.5 path=/api ok=true"));
+    log::clearAppenders();
+
+    log::LogRecord record(log::Level::Warn, "say \"hi\"\n\tback\\slash \x01 caf\xc3\xa9");
+    record.timestamp = std::chrono::sys_days(std::chrono::year(2025) / 3 / 4) + std::chrono::hours(5) + std::chrono::milliseconds(6);
+    record.threadName = "main";
+    record.fields.push_back(log::kv("count", -3));
+    record.fields.push_back(log::kv("size", 42u));
+    record.fields.push_back(log::kv("ratio", 0.25));
+    record.fields.push_back(log::kv("nan", std::numeric_limits<double>::quiet_NaN()));
+    record.fields.push_back(log::kv("name", std::string("quote\"inside a longer value")));
+
+    log::JsonFormatter json;
+    std::string expectedFile = std::filesystem::path(record.location.getFile()).filename().string();
+    EXPECT_EQ(json.format(record),
+              "{\"time\":\"2025-03-04T05:00:00.006Z\",\"level\":\"Warn\",\"thread\":\"main\",\"file\":\"" + expectedFile +
+                  "\",\"line\":" + std::to_string(record.location.getLine()) +
+                  ",\"message\":\"say \\\"hi\\\"\\n\\tback\\\\slash \\u0001 caf\xc3\xa9\"" +
+                  ",\"count\":-3,\"size\":42,\"ratio\":0.25,\"nan\":null,\"name\":\"quote\\\"inside a longer value\"}");
+
+    // Fields named like the record's own keys are prefixed instead of duplicating them
+    record.fields.clear();
+    record.fields.push_back(log::kv("level", "custom"));
+    record.fields.push_back(log::kv("message", 1));
+    const std::string collided = json.format(record);
+    EXPECT_NE(collided.find(",\"fields.level\":\"custom\",\"fields.message\":1}"), std::string::npos);
+    EXPECT_NE(collided.find("\"level\":\"Warn\""), std::string::npos);
+
+    // Every position of a word-at-a-time scan
+    for (std::size_t pos = 0; pos < 20; ++pos) {
+        std::string input(20, 'a');
+        input[pos] = '"';
+        std::string escaped;
+        log::detail::appendJsonEscaped(escaped, input);
+        EXPECT_EQ(escaped, input.substr(0, pos) + "\\\"" + input.substr(pos + 1));
+    }
+}
+
+// Dedup decorator: consecutive repeats collapse into one summary line
+TEST(NLogTest, DedupAppender) {
+    auto testAppender = std::make_unique<TestAppender>();
+    auto *appenderPtr = testAppender.get();
+    log::DedupAppender dedup(std::move(testAppender), std::chrono::seconds(10));
+    const auto &messages = appenderPtr->getMessages();
+
+    neko::SrcLocInfo here;
+    log::LogRecord record(log::Level::Error, "connection refused", here);
+    for (int i = 0; i < 5; ++i) {
+        dedup.append(record);
+    }
+    log::LogRecord other(log::Level::Info, "recovered", here);
+    dedup.appendBatch(std::span<const log::LogRecord>(&other, 1));
+
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_NE(messages[0].find("connection refused"), std::string::npos);
+    EXPECT_NE(messages[1].find("last message repeated 4 times"), std::string::npos);
+    EXPECT_NE(messages[1].find("[Error]"), std::string::npos);
+    EXPECT_NE(messages[2].find("recovered"), std::string::npos);
+    EXPECT_EQ(dedup.getSuppressedCount(), 4u);
+
+    // A repeat after the window starts a new run; flush writes a pending summary
+    appenderPtr->clear();
+    std::vector<log::LogRecord> batch(4, record);
+    batch[3].timestamp += std::chrono::seconds(11);
+    dedup.appendBatch(batch);
+    dedup.append(batch[3]);
+    dedup.flush();
+
+    ASSERT_EQ(messages.size(), 4u);
+    EXPECT_NE(messages[0].find("connection refused"), std::string::npos);
+    EXPECT_NE(messages[1].find("last message repeated 2 times"), std::string::npos);
+    EXPECT_NE(messages[2].find("connection refused"), std::string::npos);
+    EXPECT_NE(messages[3].find("last message repeated 1 time"), std::string::npos);
+
+    // Records that differ only in their fields are not repeats
+    appenderPtr->clear();
+    log::LogRecord withField = record;
+    withField.fields = {log::kv("port", 80)};
+    dedup.append(withField);
+    withField.fields = {log::kv("port", 443)};
+    dedup.append(withField);
+    dedup.append(withField);
+    dedup.flush();
+    EXPECT_EQ(messages.size(), 3u);
+}
+
+// Per-call-site rate limiting and sampling
+TEST(NLogTest, RateLimiting) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    log::clearAppenders();
+    auto testAppender = std::make_unique<TestAppender>();
+    auto *appenderPtr = testAppender.get();
+    log::addAppender(std::move(testAppender));
+    const auto &messages = appenderPtr->getMessages();
+
+    for (int i = 0; i < 10; ++i) {
+        log::everyN(3).info("every third {}", i);
+    }
+    ASSERT_EQ(messages.size(), 4u);
+    EXPECT_NE(messages[0].find("every third 0"), std::string::npos);
+    EXPECT_EQ(messages[0].find("suppressed"), std::string::npos);
+    EXPECT_NE(messages[1].find("every third 3 suppressed=2"), std::string::npos);
+    EXPECT_NE(messages[3].find("every third 9 suppressed=2"), std::string::npos);
+
+    appenderPtr->clear();
+    for (int i = 0; i < 5; ++i) {
+        log::firstN(2).warn("first two", log::kv("i", i));
+    }
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_NE(messages[1].find("first two i=1"), std::string::npos);
+
+    appenderPtr->clear();
+    int accepted = 0;
+    for (int i = 0; i < 5; ++i) {
+        if (auto limited = log::atMostPer(std::chrono::hours(1))) {
+            ++accepted;
+            limited.error("once per hour");
+        }
+    }
+    EXPECT_EQ(accepted, 1);
+    EXPECT_EQ(messages.size(), 1u);
+
+    appenderPtr->clear();
+    for (int i = 0; i < 10; ++i) {
+        log::tokenBucket(0.001, 3).info("burst of three");
+    }
+    EXPECT_EQ(messages.size(), 3u);
+
+    // Call sites are independent
+    appenderPtr->clear();
+    log::firstN(1).info("site a");
+    log::firstN(1).info("site b");
+    EXPECT_EQ(messages.size(), 2u);
+
+    // Calls at a disabled level do not use up the budget
+    appenderPtr->clear();
+    log::setLevel(log::Level::Info);
+    for (int i = 0; i < 3; ++i) {
+        log::firstN(1).debug("disabled");
+        log::firstN(1).info("enabled {}", i);
+    }
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_NE(messages[0].find("enabled 0"), std::string::npos);
+
+    // Decisions made through operator bool keep the suppressed count for the next written line
+    appenderPtr->clear();
+    for (int i = 0; i < 6; ++i) {
+        auto limited = log::everyN(2);
+        if (limited && i == 4) {
+            limited.warn("written");
+            EXPECT_EQ(limited.getSuppressed(), 2u);
+        }
+    }
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_NE(messages[0].find("written suppressed=2"), std::string::npos);
+
+    // Limiters on one line with different rules, and limiters of different loggers, keep separate state
+    appenderPtr->clear();
+    log::Logger other(log::Level::Debug);
+    other.clearAppenders();
+    auto otherAppender = std::make_unique<TestAppender>();
+    auto *otherPtr = otherAppender.get();
+    other.addAppender(std::move(otherAppender));
+    for (int i = 0; i < 3; ++i) {
+        log::firstN(1).info("one"); log::firstN(2).info("two"); other.firstN(1).info("other");
+    }
+    EXPECT_EQ(messages.size(), 3u);
+    EXPECT_EQ(otherPtr->getMessages().size(), 1u);
+
+    // Limiting keeps working after more limiters than one table holds have been created
+    appenderPtr->clear();
+    for (std::uint64_t n = 1; n <= 3000; ++n) {
+        log::firstN(n).debug("never written");
+    }
+    for (int i = 0; i < 3; ++i) {
+        log::firstN(1).info("after the table filled");
+    }
+    EXPECT_EQ(messages.size(), 1u);
+
+    log::setLevel(log::Level::Debug);
+    log::clearAppenders();
+}
+
+// Timestamp rendering with the per-second prefix cache
+TEST(NLogTest, DefaultFormatterTimestamp) {
+    using namespace std::chrono;
+    log::DefaultFormatter formatter("", false, log::TimeZone::Utc);
+
+    log::LogRecord record(log::Level::Info, "timestamp test");
+    record.timestamp = sys_days{year{2024} / 1 / 2} + hours{3} + minutes{4} + seconds{5} + milliseconds{678};
+    EXPECT_EQ(formatter.format(record).rfind("[2024-01-02 03:04:05.678] [Info]", 0), 0u);
+
+    // Same second, only the milliseconds change
+    record.timestamp += milliseconds{300};
+    EXPECT_EQ(formatter.format(record).rfind("[2024-01-02 03:04:05.978]", 0), 0u);
+
+    // Crossing into the next second and day re-renders the prefix
+    record.timestamp = sys_days{year{2024} / 12 / 31} + hours{23} + minutes{59} + seconds{59} + milliseconds{999};
+    EXPECT_EQ(formatter.format(record).rfind("[2024-12-31 23:59:59.999]", 0), 0u);
+    record.timestamp += milliseconds{1};
+    EXPECT_EQ(formatter.format(record).rfind("[2025-01-01 00:00:00.000]", 0), 0u);
+}
+
+// Source path truncation without filesystem access
+TEST(NLogTest, DefaultFormatterPaths) {
+    EXPECT_EQ(log::detail::fileName("/to/path/src/main.cpp"), "main.cpp");
+    EXPECT_EQ(log::detail::fileName("C:\\to\\path\\main.cpp"), "main.cpp");
+    EXPECT_EQ(log::detail::relativePath("/to/path/src/main.cpp", "/to/path/"), "src/main.cpp");
+    EXPECT_EQ(log::detail::relativePath("/to/path/src/main.cpp", "/to/path"), "src/main.cpp");
+    EXPECT_EQ(log::detail::relativePath("C:\\to\\path\\src\\main.cpp", "C:/to/path"), "src\\main.cpp");
+
+    neko::SrcLocInfo location;
+    std::filesystem::path source(location.getFile());
+
+    log::DefaultFormatter nameOnly;
+    EXPECT_EQ(nameOnly.displayPath(location.getFile()), source.filename().string());
+
+    log::DefaultFormatter relative(source.parent_path().parent_path().string());
+    std::string expected = (source.parent_path().filename() / source.filename()).string();
+    // Second lookup is served from the per-file cache
+    EXPECT_EQ(relative.displayPath(location.getFile()), expected);
+    EXPECT_EQ(relative.displayPath(location.getFile()), expected);
+
+    log::DefaultFormatter full("", true);
+    EXPECT_EQ(full.displayPath(location.getFile()), location.getFile());
+
+    // More files than the lock-free table holds still resolve, and assignment keeps earlier views valid
+    std::vector<std::string> files;
+    for (int i = 0; i < 200; ++i) {
+        files.push_back("/to/path/file" + std::to_string(i) + ".cpp");
+    }
+    for (int round = 0; round < 2; ++round) {
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            EXPECT_EQ(nameOnly.displayPath(files[i].c_str()), "file" + std::to_string(i) + ".cpp");
+        }
+    }
+    std::string_view before = relative.displayPath(location.getFile());
+    relative = full;
+    EXPECT_EQ(before, expected);
+    EXPECT_EQ(relative.displayPath(location.getFile()), location.getFile());
+}
+
 // Console appender test
 TEST(NLogTest, ConsoleAppender) {
     log::clearAppenders();
@@ -302,6 +1278,770 @@ TEST(NLogTest, ConsoleAppender) {
     log::clearAppenders();
 }
 
+// Console colour modes, buffering and direct descriptor writes
+TEST(NLogTest, ConsoleAppenderOutput) {
+    std::ostringstream captured;
+    auto *previous = std::cout.rdbuf(captured.rdbuf());
+    auto *previousErr = std::cerr.rdbuf(captured.rdbuf());
+    {
+        log::ConsoleAppender appender;
+        appender.setColorMode(log::ColorMode::Never);
+        captured.str("");
+
+        neko::SrcLocInfo here;
+        log::LogRecord record(log::Level::Debug, "plain line", here);
+        appender.append(record);
+        EXPECT_NE(captured.str().find("plain line\n"), std::string::npos);
+        EXPECT_EQ(captured.str().find('\033'), std::string::npos);
+
+        appender.setColorMode(log::ColorMode::Always);
+        EXPECT_TRUE(appender.isColored());
+        appender.append(record);
+        EXPECT_NE(captured.str().find("\033[34m"), std::string::npos);
+
+        // Buffered output stays pending until the policy is due or flush() is called
+        appender.setColorMode(log::ColorMode::Never);
+        appender.setFlushPolicy(log::FlushPolicy::buffered(1024 * 1024, std::chrono::milliseconds(0), log::Level::Off));
+        captured.str("");
+        record.message = "buffered line";
+        appender.append(record);
+        EXPECT_TRUE(captured.str().empty());
+        appender.flush();
+        EXPECT_NE(captured.str().find("buffered line"), std::string::npos);
+
+        // Error lines go to standard error, yet a batch comes out in record order where both streams meet
+        captured.str("");
+        const std::array<log::LogRecord, 3> batch{log::LogRecord(log::Level::Info, "first", here),
+                                                  log::LogRecord(log::Level::Error, "second", here),
+                                                  log::LogRecord(log::Level::Info, "third", here)};
+        appender.appendBatch(batch);
+        appender.flush();
+        const std::string ordered = captured.str();
+        ASSERT_NE(ordered.find("third\n"), std::string::npos);
+        EXPECT_LT(ordered.find("first\n"), ordered.find("second\n"));
+        EXPECT_LT(ordered.find("second\n"), ordered.find("third\n"));
+    }
+    std::cout.rdbuf(previous);
+    std::cerr.rdbuf(previousErr);
+
+#if NEKO_LOG_HAS_FD_IO && !defined(_WIN32)
+    // Direct mode writes to descriptor 1 without touching std::cout
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    std::cout.flush();
+    int savedStdout = ::dup(1);
+    ::dup2(fds[1], 1);
+    {
+        log::ConsoleAppender appender;
+        appender.setColorMode(log::ColorMode::Never);
+        // Still buffered in iostreams when the appender switches
+        std::cout << "before the switch\n";
+        appender.setOutput(log::ConsoleOutput::Direct);
+        neko::SrcLocInfo here;
+        appender.append(log::LogRecord(log::Level::Info, "direct line", here));
+        appender.flush();
+    }
+    ::dup2(savedStdout, 1);
+    ::close(savedStdout);
+    ::close(fds[1]);
+
+    std::string piped;
+    char chunk[256];
+    for (ssize_t n; (n = ::read(fds[0], chunk, sizeof(chunk))) > 0;) {
+        piped.append(chunk, static_cast<std::size_t>(n));
+    }
+    ::close(fds[0]);
+    // Earlier iostream output, then the banner and the record, both written with write(2)
+    const auto before = piped.find("before the switch\n");
+    const auto banner = piped.find("=== ConsoleAppender initialized ===");
+    const auto line = piped.find("direct line\n");
+    ASSERT_NE(before, std::string::npos);
+    ASSERT_NE(banner, std::string::npos);
+    ASSERT_NE(line, std::string::npos);
+    EXPECT_LT(before, banner);
+    EXPECT_LT(banner, line);
+#endif
+}
+
+// Async ring buffer test with many producers and a small queue
+TEST(NLogTest, AsyncMultiProducer) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    log::clearAppenders();
+
+    auto testAppender = std::make_unique<TestAppender>();
+    auto *appenderPtr = testAppender.get();
+    log::addAppender(std::move(testAppender));
+
+    log::setQueueCapacity(16);
+    EXPECT_EQ(log::getQueueCapacity(), 16u);
+
+    log::setMode(neko::SyncMode::Async);
+    std::thread logThread([] { log::runLogLoop(); });
+
+    constexpr int producerCount = 4;
+    constexpr int messagesPerProducer = 500;
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producerCount; ++i) {
+        producers.emplace_back([i] {
+            for (int j = 0; j < messagesPerProducer; ++j) {
+                log::info("producer {} message {}", {}, i, j);
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    log::stopLogLoop();
+    logThread.join();
+
+    EXPECT_EQ(appenderPtr->getMessages().size(), static_cast<std::size_t>(producerCount * messagesPerProducer));
+    EXPECT_TRUE(appenderPtr->containsMessage("producer 3 message 499"));
+
+    log::setQueueCapacity(8192);
+    log::clearAppenders();
+}
+
+// Managed backend test: the logger owns the consumer thread and drains it on stop
+TEST(NLogTest, AsyncBackend) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    log::Logger logger(log::Level::Debug);
+    logger.clearAppenders();
+    auto testAppender = std::make_unique<TestAppender>();
+    auto *appenderPtr = testAppender.get();
+    logger.addAppender(std::move(testAppender));
+
+    log::AsyncOptions options;
+    options.queueCapacity = 64;
+    options.maxBatchSize = 16;
+    ASSERT_TRUE(logger.startAsync(options));
+    EXPECT_FALSE(logger.startAsync(options));
+    EXPECT_EQ(logger.getMode(), neko::SyncMode::Async);
+    EXPECT_EQ(logger.getQueueCapacity(), 64u);
+
+    constexpr int producerCount = 4;
+    constexpr int messagesPerProducer = 1000;
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producerCount; ++i) {
+        producers.emplace_back([&logger, i] {
+            for (int j = 0; j < messagesPerProducer; ++j) {
+                logger.info("backend {} message {}", {}, i, j);
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    // Everything logged before stopAsync is written when it returns
+    logger.stopAsync();
+    EXPECT_EQ(logger.getMode(), neko::SyncMode::Sync);
+    const auto &messages = appenderPtr->getMessages();
+    ASSERT_EQ(messages.size(), static_cast<std::size_t>(producerCount * messagesPerProducer));
+
+    // Each producer's records keep their order
+    for (int i = 0; i < producerCount; ++i) {
+        int next = 0;
+        const std::string prefix = "backend " + std::to_string(i) + " message ";
+        for (const auto &message : messages) {
+            if (auto pos = message.find(prefix); pos != std::string::npos) {
+                EXPECT_EQ(message.substr(pos + prefix.size()), std::to_string(next));
+                ++next;
+            }
+        }
+        EXPECT_EQ(next, messagesPerProducer);
+    }
+
+    // The backend can be started again after stopping
+    ASSERT_TRUE(logger.startAsync(options));
+    logger.info("after restart");
+    logger.stopAsync();
+    EXPECT_TRUE(appenderPtr->containsMessage("after restart"));
+}
+
+// Stopping never strands a record in the queue, and a leftover queue is written rather than discarded
+TEST(NLogTest, AsyncStopHandshake) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    class CountingAppender : public log::IAppender {
+    public:
+        std::atomic<std::size_t> count = 0;
+        void append(const log::LogRecord &) override {
+            count.fetch_add(1);
+        }
+        void flush() override {}
+    };
+
+    log::Logger logger(log::Level::Debug);
+    logger.clearAppenders();
+    auto counting = std::make_unique<CountingAppender>();
+    auto *appender = counting.get();
+    logger.addAppender(std::move(counting));
+
+    // Records queued without a consumer are written by the next startAsync
+    logger.setMode(neko::SyncMode::Async);
+    for (int i = 0; i < 3; ++i) {
+        logger.info("left in the queue");
+    }
+    logger.setMode(neko::SyncMode::Sync);
+    EXPECT_EQ(appender->count.load(), 0u);
+
+    log::AsyncOptions options;
+    options.queueCapacity = 8;
+    ASSERT_TRUE(logger.startAsync(options));
+    EXPECT_EQ(appender->count.load(), 3u);
+    EXPECT_FALSE(logger.setQueueCapacity(16));
+    EXPECT_EQ(logger.getQueueCapacity(), 8u);
+
+    // Producers racing with stopAsync either make it into the final drain or write synchronously
+    constexpr int producerCount = 4;
+    constexpr int messagesPerProducer = 2000;
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producerCount; ++i) {
+        producers.emplace_back([&logger] {
+            for (int j = 0; j < messagesPerProducer; ++j) {
+                logger.info("racing {}", {}, j);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    logger.stopAsync();
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(appender->count.load(), 3u + producerCount * messagesPerProducer);
+    EXPECT_TRUE(logger.setQueueCapacity(16));
+
+    // Still in async mode without a consumer: the queue is written and then replaced with the requested capacity
+    std::size_t written = appender->count.load();
+    logger.setMode(neko::SyncMode::Async);
+    logger.info("queued while async");
+    logger.info("queued while async");
+    EXPECT_EQ(appender->count.load(), written);
+    options.queueCapacity = 32;
+    ASSERT_TRUE(logger.startAsync(options));
+    EXPECT_EQ(appender->count.load(), written + 2);
+    EXPECT_EQ(logger.getQueueCapacity(), 32u);
+    logger.stopAsync();
+
+    // A log loop run by the application already consumes the queue, so no second consumer is started
+    written = appender->count.load();
+    logger.setMode(neko::SyncMode::Async);
+    std::thread loop([&logger] { logger.runLoop(); });
+    logger.info("taken by runLoop");
+    while (appender->count.load() == written) {
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(logger.startAsync(options));
+    EXPECT_EQ(logger.getMode(), neko::SyncMode::Async);
+    logger.stopLoop();
+    loop.join();
+}
+
+// Batch append test: the async backend hands appenders runs of enabled records
+TEST(NLogTest, AppendBatch) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    class BatchAppender : public log::IAppender {
+    public:
+        std::vector<std::string> messages;
+        std::size_t batches = 0;
+        std::size_t singles = 0;
+
+        void append(const log::LogRecord &record) override {
+            ++singles;
+            messages.push_back(record.message);
+        }
+
+        void appendBatch(std::span<const log::LogRecord> records) override {
+            ++batches;
+            for (const auto &record : records) {
+                messages.push_back(record.message);
+            }
+        }
+    };
+
+    const std::string testFile = "test_batch_log.txt";
+    log::Logger logger(log::Level::Debug);
+    logger.clearAppenders();
+    auto all = std::make_unique<BatchAppender>();
+    auto warnOnly = std::make_unique<BatchAppender>();
+    warnOnly->setLevel(log::Level::Warn);
+    auto *allPtr = all.get();
+    auto *warnPtr = warnOnly.get();
+    logger.addAppender(std::move(all));
+    logger.addAppender(std::move(warnOnly));
+    logger.addAppender(std::make_unique<log::FileAppender>(testFile, true));
+
+    // Fill the queue before the backend starts so it is taken in batches
+    logger.setQueueCapacity(256);
+    logger.setMode(neko::SyncMode::Async);
+    for (int i = 0; i < 200; ++i) {
+        if (i % 50 == 49) {
+            logger.warn("warn " + std::to_string(i));
+        } else {
+            logger.info("info " + std::to_string(i));
+        }
+    }
+    log::AsyncOptions options;
+    options.queueCapacity = 256;
+    options.maxBatchSize = 64;
+    logger.startAsync(options);
+    logger.stopAsync();
+
+    ASSERT_EQ(allPtr->messages.size(), 200u);
+    EXPECT_EQ(allPtr->singles, 0u);
+    EXPECT_EQ(allPtr->batches, 4u);
+    EXPECT_EQ(allPtr->messages.front(), "info 0");
+    EXPECT_EQ(allPtr->messages.back(), "warn 199");
+
+    // Only the enabled records, one run each
+    EXPECT_EQ(warnPtr->messages, (std::vector<std::string>{"warn 49", "warn 99", "warn 149", "warn 199"}));
+    EXPECT_EQ(warnPtr->batches, 4u);
+
+    // The file appender wrote every record of each batch in order
+    logger.clearAppenders();
+    std::ifstream file(testFile);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(testFile);
+    EXPECT_EQ(std::count(content.begin(), content.end(), '\n'), 203); // Three banner lines
+    EXPECT_LT(content.find("info 0\n"), content.find("warn 199\n"));
+}
+
+// Async appender test: a blocked sink falls behind on its own queue without holding up the others
+TEST(NLogTest, AsyncAppender) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    class BlockingAppender : public log::IAppender {
+    public:
+        std::atomic<bool> released = false;
+        std::mutex mutex;
+        std::vector<std::string> messages;
+
+        void append(const log::LogRecord &record) override {
+            while (!released.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.push_back(record.message);
+        }
+    };
+
+    log::Logger logger(log::Level::Debug);
+    logger.clearAppenders();
+
+    auto blocking = std::make_unique<BlockingAppender>();
+    auto *blockingPtr = blocking.get();
+    log::AsyncOptions options;
+    options.queueCapacity = 8;
+    options.overflowPolicy = log::OverflowPolicy::DropNewest;
+    auto asyncAppender = std::make_unique<log::AsyncAppender>(std::move(blocking), options);
+    auto *asyncPtr = asyncAppender.get();
+    logger.addAppender(std::move(asyncAppender));
+
+    auto fast = std::make_unique<TestAppender>();
+    auto *fastPtr = fast.get();
+    logger.addAppender(std::move(fast));
+
+    for (int i = 0; i < 100; ++i) {
+        logger.info("record " + std::to_string(i));
+    }
+
+    // The fast appender got everything while the blocked one is stuck
+    EXPECT_EQ(fastPtr->getMessages().size(), 100u);
+    auto stats = asyncPtr->getStats();
+    EXPECT_GT(stats.dropped, 0u);
+    EXPECT_EQ(stats.enqueued + stats.dropped, 100u);
+    EXPECT_LE(stats.pending, stats.enqueued);
+
+    blockingPtr->released = true;
+    logger.flush();
+
+    stats = asyncPtr->getStats();
+    EXPECT_EQ(stats.pending, 0u);
+    EXPECT_EQ(stats.written, stats.enqueued);
+    EXPECT_GT(stats.maxLag.count(), 0);
+
+    // Every accepted record arrives in order, followed by the drop summary
+    std::lock_guard<std::mutex> lock(blockingPtr->mutex);
+    ASSERT_EQ(blockingPtr->messages.size(), stats.written + 1);
+    EXPECT_EQ(blockingPtr->messages.front(), "record 0");
+    EXPECT_EQ(blockingPtr->messages.back(), std::to_string(stats.dropped) + " log records dropped, the appender queue was full");
+}
+
+// Overflow policy test: a full queue drops records according to the policy and reports the count
+TEST(NLogTest, AsyncOverflowPolicy) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    auto runCase = [](log::OverflowPolicy policy, auto &&produce) {
+        log::Logger logger(log::Level::Debug);
+        logger.clearAppenders();
+        auto testAppender = std::make_unique<TestAppender>();
+        auto *appenderPtr = testAppender.get();
+        logger.addAppender(std::move(testAppender));
+
+        logger.setQueueCapacity(4);
+        logger.setOverflowPolicy(policy);
+        logger.setMode(neko::SyncMode::Async);
+
+        // No consumer yet, so the queue fills up after four records
+        produce(logger);
+
+        // Drain on the current thread
+        logger.stopLoop();
+        logger.runLoop();
+        return std::make_pair(appenderPtr->getMessages(), logger.getDroppedCount());
+    };
+    auto produceTen = [](log::Logger &logger) {
+        for (int i = 0; i < 10; ++i) {
+            logger.info("record " + std::to_string(i));
+        }
+    };
+
+    auto [newest, newestDropped] = runCase(log::OverflowPolicy::DropNewest, produceTen);
+    EXPECT_EQ(newestDropped, 6u);
+    ASSERT_EQ(newest.size(), 5u);
+    EXPECT_NE(newest.front().find("record 0"), std::string::npos);
+    EXPECT_NE(newest[3].find("record 3"), std::string::npos);
+    EXPECT_NE(newest.back().find("[Warn]"), std::string::npos);
+    EXPECT_NE(newest.back().find("6 log records dropped"), std::string::npos);
+
+    auto [oldest, oldestDropped] = runCase(log::OverflowPolicy::DropOldest, produceTen);
+    EXPECT_EQ(oldestDropped, 6u);
+    ASSERT_EQ(oldest.size(), 5u);
+    EXPECT_NE(oldest.front().find("record 6"), std::string::npos);
+    EXPECT_NE(oldest[3].find("record 9"), std::string::npos);
+    EXPECT_NE(oldest.back().find("6 log records dropped"), std::string::npos);
+
+    auto [belowLevel, belowLevelDropped] = runCase(log::OverflowPolicy::DropBelowLevel, [](log::Logger &logger) {
+        for (int i = 0; i < 3; ++i) {
+            logger.info("record " + std::to_string(i));
+        }
+        logger.warn("kept warning");
+        logger.info("dropped info");
+        logger.info("dropped info again");
+    });
+    EXPECT_EQ(belowLevelDropped, 2u);
+    ASSERT_EQ(belowLevel.size(), 5u);
+    EXPECT_NE(belowLevel[3].find("kept warning"), std::string::npos);
+    EXPECT_NE(belowLevel.back().find("2 log records dropped"), std::string::npos);
+}
+
+// Deferred formatting test: arguments are captured and formatted by the log loop
+TEST(NLogTest, AsyncDeferredFormatting) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    log::clearAppenders();
+
+    auto testAppender = std::make_unique<TestAppender>();
+    auto *appenderPtr = testAppender.get();
+    log::addAppender(std::move(testAppender));
+
+    log::setMode(neko::SyncMode::Async);
+
+    std::string owned = "owned";
+    std::string_view view = "view";
+    const char *cstr = "cstr";
+    log::info("ints {} {} {:#x}", {}, -42, 7u, static_cast<unsigned char>(255));
+    log::info("floats {:.2f} {}", {}, 3.14159, 0.5f);
+    log::info("misc {} {} {}", {}, true, 'c', nullptr);
+    log::info("strings {} {:>6} {} {}", {}, owned, view, cstr, "literal");
+    // Too large for the inline buffer, formatted on the caller instead
+    log::info("large {}", {}, std::string(512, 'x'));
+
+    // Nothing is formatted until the loop runs
+    EXPECT_TRUE(appenderPtr->getMessages().empty());
+
+    std::thread logThread([] { log::runLogLoop(); });
+    log::stopLogLoop();
+    logThread.join();
+
+    ASSERT_EQ(appenderPtr->getMessages().size(), 5u);
+    EXPECT_TRUE(appenderPtr->containsMessage("ints -42 7 0xff"));
+    EXPECT_TRUE(appenderPtr->containsMessage("floats 3.14 0.5"));
+    EXPECT_TRUE(appenderPtr->containsMessage("misc true c 0x0"));
+    EXPECT_TRUE(appenderPtr->containsMessage("strings owned   view cstr literal"));
+    EXPECT_TRUE(appenderPtr->containsMessage("large " + std::string(512, 'x')));
+
+    log::clearAppenders();
+}
+
+#if NEKO_LOG_HAS_CRASH_HANDLER
+// Records still queued when the process crashes are written by the fatal signal handler
+TEST(NLogTest, CrashHandler) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    const std::string testFile = "test_crash.log";
+    std::filesystem::remove(testFile);
+
+    // The death test forks a child that logs without a backend, so the records stay queued until it aborts
+    EXPECT_EXIT({
+        log::Logger logger(log::Level::Debug);
+        logger.clearAppenders();
+        logger.addFileAppender(testFile);
+        logger.info("written before the crash");
+        ASSERT_TRUE(logger.installCrashHandler(testFile, false));
+
+        logger.setMode(neko::SyncMode::Async);
+        logger.info("pending one");
+        logger.warn("pending {} of {}", {}, 2, "two");
+        logger.error("pending three", {}, log::kv("user", "alice"), log::kv("code", 7));
+        std::abort();
+    },
+                ::testing::KilledBySignal(SIGABRT), "");
+
+    std::ifstream file(testFile);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        lines.push_back(line);
+    }
+    ASSERT_GE(lines.size(), 5u);
+    const auto tail = std::span(lines).last(5);
+    EXPECT_NE(tail[0].find("written before the crash"), std::string::npos);
+    EXPECT_NE(tail[1].find("Fatal signal " + std::to_string(SIGABRT)), std::string::npos);
+    EXPECT_NE(tail[2].find("[Info]"), std::string::npos);
+    EXPECT_NE(tail[2].find("pending one"), std::string::npos);
+    EXPECT_NE(tail[3].find("pending 2 of two"), std::string::npos);
+    EXPECT_NE(tail[4].find("[Error]"), std::string::npos);
+    EXPECT_NE(tail[4].find("pending three user=alice code=7"), std::string::npos);
+
+    file.close();
+    std::filesystem::remove(testFile);
+}
+
+// The handler drains the queue while the backend is still consuming it
+TEST(NLogTest, CrashHandlerLiveBackend) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    const std::string testFile = "test_crash_live.log";
+    std::filesystem::remove(testFile);
+
+    class SlowAppender : public log::IAppender {
+    public:
+        void append(const log::LogRecord &) override {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    EXPECT_EXIT({
+        log::Logger logger(log::Level::Debug);
+        logger.clearAppenders();
+        logger.addAppender(std::make_unique<SlowAppender>());
+        ASSERT_TRUE(logger.installCrashHandler("", false));
+        logger.startAsync();
+        // Reinstalling while the backend runs only swaps the writer
+        ASSERT_TRUE(logger.installCrashHandler(testFile, false));
+        for (int i = 0; i < 1000; ++i) {
+            logger.info("live {}", {}, i);
+        }
+        std::abort();
+    },
+                ::testing::KilledBySignal(SIGABRT), "");
+
+    std::ifstream file(testFile);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        lines.push_back(line);
+    }
+    ASSERT_GE(lines.size(), 2u);
+    EXPECT_NE(lines[0].find("Fatal signal " + std::to_string(SIGABRT)), std::string::npos);
+    EXPECT_NE(lines.back().find("live 999"), std::string::npos);
+    // Records the backend took are missing from the front, the rest are written once and in order
+    int previous = -1;
+    for (std::size_t i = 1; i < lines.size(); ++i) {
+        const auto pos = lines[i].find("live ");
+        ASSERT_NE(pos, std::string::npos);
+        const int value = std::stoi(lines[i].substr(pos + 5));
+        EXPECT_GT(value, previous);
+        previous = value;
+    }
+
+    file.close();
+    std::filesystem::remove(testFile);
+}
+
+namespace {
+    volatile std::size_t overflowLimit = std::numeric_limits<std::size_t>::max();
+
+    [[gnu::noinline]] std::size_t overflowStack(std::size_t depth) {
+        volatile char frame[1024];
+        frame[depth % sizeof(frame)] = static_cast<char>(depth);
+        if (depth == overflowLimit) {
+            return depth;
+        }
+        return overflowStack(depth + 1) + static_cast<std::size_t>(frame[0]);
+    }
+} // namespace
+
+// The handler runs on an alternate stack, so a stack overflow still gets its records written
+TEST(NLogTest, CrashHandlerStackOverflow) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    const std::string testFile = "test_crash_overflow.log";
+    std::filesystem::remove(testFile);
+
+    EXPECT_EXIT({
+        log::Logger logger(log::Level::Debug);
+        logger.clearAppenders();
+        ASSERT_TRUE(logger.installCrashHandler(testFile, false));
+        logger.setMode(neko::SyncMode::Async);
+        logger.info("pending before the overflow");
+        overflowStack(0);
+        std::exit(0);
+    },
+                ::testing::KilledBySignal(SIGSEGV), "");
+
+    std::ifstream file(testFile);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("Fatal signal " + std::to_string(SIGSEGV)), std::string::npos);
+    EXPECT_NE(content.find("pending before the overflow"), std::string::npos);
+
+    file.close();
+    std::filesystem::remove(testFile);
+}
+#endif
+
+// Once records and ring slots have grown to the message size, logging no longer allocates
+TEST(NLogTest, AllocationFreeLogging) {
+    SKIP_UNLESS_ACTIVE(log::Level::Info);
+
+    class CountingAppender : public log::IAppender {
+    public:
+        std::atomic<std::size_t> count = 0;
+        void append(const log::LogRecord &) override {
+            count.fetch_add(1, std::memory_order_release);
+        }
+        void flush() override {}
+    };
+
+    log::Logger logger(log::Level::Debug);
+    logger.clearAppenders();
+    auto counting = std::make_unique<CountingAppender>();
+    auto *appender = counting.get();
+    logger.addAppender(std::move(counting));
+
+    const std::string owned = "a message longer than the small string buffer";
+    auto logAll = [&](int rounds) {
+        for (int i = 0; i < rounds; ++i) {
+            logger.info("a literal message longer than the small string buffer");
+            logger.info(owned);
+            logger.info("formatted {} {:.2f} {}", {}, i, 0.5, "with a string argument");
+            logger.info("caller formatted {}", {}, owned);
+        }
+    };
+    auto measure = [&](int rounds) {
+        const std::size_t target = appender->count.load() + static_cast<std::size_t>(rounds) * 4;
+        allocationCount.store(0);
+        countAllocations.store(true);
+        logAll(rounds);
+        while (appender->count.load(std::memory_order_acquire) < target) {
+            std::this_thread::yield();
+        }
+        countAllocations.store(false);
+        return allocationCount.load();
+    };
+
+    // Sync mode: the thread's scratch record is reused
+    logAll(10);
+    EXPECT_EQ(measure(1000), 0u);
+
+    // Async mode: ring slots keep their buffers and the backend's batch entries are reserved up front
+    log::AsyncOptions options;
+    options.queueCapacity = 64;
+    ASSERT_TRUE(logger.startAsync(options));
+    logAll(1000);
+    EXPECT_EQ(measure(1000), 0u);
+    logger.stopAsync();
+}
+
+// Appenders can be replaced while other threads are logging
+TEST(NLogTest, ConcurrentAppenderUpdates) {
+    class CountingAppender : public log::IAppender {
+    public:
+        std::shared_ptr<std::atomic<int>> count;
+        explicit CountingAppender(std::shared_ptr<std::atomic<int>> c) : count(std::move(c)) {}
+        void append(const log::LogRecord &) override {
+            count->fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    log::clearAppenders();
+    auto count = std::make_shared<std::atomic<int>>(0);
+    std::atomic<bool> running = true;
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < 4; ++i) {
+        producers.emplace_back([&running] {
+            while (running.load()) {
+                log::info("concurrent message");
+            }
+        });
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        log::addAppender(std::make_unique<CountingAppender>(count));
+        if (i % 10 == 0) {
+            log::clearAppenders();
+        }
+    }
+    running = false;
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    log::clearAppenders();
+    int before = count->load();
+    log::info("after clear");
+    EXPECT_EQ(count->load(), before) << "Cleared appenders must not receive new records";
+}
+
+// Appenders that are not thread-safe are never entered by two threads at once
+TEST(NLogTest, SerializedAppenders) {
+    class OverlapAppender : public log::IAppender {
+    public:
+        std::atomic<int> inside = 0;
+        std::atomic<int> overlaps = 0;
+        void append(const log::LogRecord &) override {
+            if (inside.fetch_add(1) != 0) {
+                overlaps.fetch_add(1);
+            }
+            std::this_thread::yield();
+            inside.fetch_sub(1);
+        }
+        void flush() override {
+            append(log::LogRecord());
+        }
+    };
+
+    log::Logger logger(log::Level::Debug);
+    logger.clearAppenders();
+    auto overlap = std::make_unique<OverlapAppender>();
+    auto *appender = overlap.get();
+    EXPECT_FALSE(appender->isThreadSafe());
+    logger.addAppender(std::move(overlap));
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < 4; ++i) {
+        producers.emplace_back([&logger] {
+            for (int j = 0; j < 2000; ++j) {
+                logger.info("serialized");
+                if (j % 100 == 0) {
+                    logger.flush();
+                }
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(appender->overlaps.load(), 0);
+    EXPECT_TRUE(log::FileAppender("test_serialized.log").isThreadSafe());
+    std::filesystem::remove("test_serialized.log");
+}
+
 // Test fixture for cleanup
 class NLogTestFixture : public ::testing::Test {
 protected:
@@ -0,0 +1,110 @@
+/**
+ * @file nlog_decode.cpp
+ * @brief Convert binary logs written by neko::log::BinaryAppender to text
+ * @author moehoshio
+ * @copyright Copyright (c) 2025 Hoshi
+ * @license MIT OR Apache-2.0
+ */
+
+#include <neko/log/nlog.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    void printUsage(std::string_view program) {
+        std::cerr << "Usage: " << program << " [options] <file>...\n"
+                  << "Print binary log files in the DefaultFormatter text layout.\n\n"
+                  << "Options:\n"
+                  << "  -o <file>      Write the text to <file> instead of standard output\n"
+                  << "  --root <path>  Show source paths relative to <path>\n"
+                  << "  --full-path    Show full source paths\n"
+                  << "  --utc          Show timestamps in UTC instead of local time\n"
+                  << "  -h, --help     Show this help\n";
+    }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    using namespace neko;
+
+    // Nothing is logged here; drop the global logger's console appender so standard output only carries decoded text
+    log::clearAppenders();
+
+    std::string rootPath;
+    bool useFullPath = false;
+    log::TimeZone timeZone = log::TimeZone::Local;
+    std::string outputPath;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "--root" && i + 1 < argc) {
+            rootPath = argv[++i];
+        } else if (arg == "--full-path") {
+            useFullPath = true;
+        } else if (arg == "--utc") {
+            timeZone = log::TimeZone::Utc;
+        } else if (arg.starts_with("-")) {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 2;
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+
+    if (files.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::ofstream outputFile;
+    if (!outputPath.empty()) {
+        outputFile.open(outputPath, std::ios::trunc);
+        if (!outputFile.is_open()) {
+            std::cerr << outputPath << ": cannot open output file\n";
+            return 1;
+        }
+    }
+    std::ostream &out = outputPath.empty() ? std::cout : outputFile;
+
+    int status = 0;
+    for (const auto &path : files) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            std::cerr << path << ": cannot open file\n";
+            status = 1;
+            continue;
+        }
+
+        try {
+            log::BinaryLogReader reader(in);
+            log::DefaultFormatter formatter(rootPath, useFullPath, timeZone);
+            log::BinaryLogReader::Entry entry;
+            std::string line;
+            while (reader.next(entry)) {
+                line.clear();
+                formatter.formatFieldsTo(line, entry.level, entry.timestamp, entry.threadName, entry.file, entry.line, entry.message);
+                line += '\n';
+                out << line;
+            }
+            if (reader.isIncomplete()) {
+                std::cerr << path << ": stopped at an incomplete or damaged frame\n";
+            }
+        } catch (const ex::FileError &e) {
+            std::cerr << path << ": " << e.what() << "\n";
+            status = 1;
+        }
+    }
+    return status;
+}